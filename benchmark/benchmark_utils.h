@@ -0,0 +1,637 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+  #include <pthread.h>
+  #include <sched.h>
+#endif
+
+/**
+ * Helpers shared by the benchmark suites: command line options, thread pinning, core selection
+ * by topology, run statistics and CSV / JSON / table reports
+ */
+namespace bench
+{
+
+/**
+ * Parses --key=value arguments, a bare --key is stored with an empty value
+ */
+class Options
+{
+public:
+  Options(int argc, char** argv)
+  {
+    for (int i = 1; i < argc; ++i)
+    {
+      std::string const arg{argv[i]};
+
+      if (arg.rfind("--", 0) != 0)
+      {
+        throw std::runtime_error("Unexpected argument " + arg);
+      }
+
+      size_t const eq = arg.find('=');
+      if (eq == std::string::npos)
+      {
+        _values[arg.substr(2)] = std::string{};
+      }
+      else
+      {
+        _values[arg.substr(2, eq - 2)] = arg.substr(eq + 1);
+      }
+    }
+  }
+
+  [[nodiscard]] bool has(std::string const& key) const { return _values.find(key) != _values.end(); }
+
+  [[nodiscard]] std::string get(std::string const& key, std::string const& default_value) const
+  {
+    auto const it = _values.find(key);
+    return (it == _values.end()) ? default_value : it->second;
+  }
+
+  [[nodiscard]] size_t get(std::string const& key, size_t default_value) const
+  {
+    auto const it = _values.find(key);
+    return (it == _values.end()) ? default_value : std::stoull(it->second);
+  }
+
+  /**
+   * @return a comma separated list, e.g. --readers=1,2,4
+   */
+  [[nodiscard]] std::vector<size_t> get_list(std::string const& key, std::vector<size_t> const& default_value) const
+  {
+    auto const it = _values.find(key);
+    if (it == _values.end())
+    {
+      return default_value;
+    }
+
+    return parse_list(it->second);
+  }
+
+  /**
+   * @return a comma separated list of names, e.g. --benchmarks=ops,rtt
+   */
+  [[nodiscard]] std::vector<std::string> get_names(std::string const& key,
+                                                   std::vector<std::string> const& default_value) const
+  {
+    auto const it = _values.find(key);
+    if (it == _values.end())
+    {
+      return default_value;
+    }
+
+    std::vector<std::string> names;
+    std::stringstream ss{it->second};
+    std::string item;
+
+    while (std::getline(ss, item, ','))
+    {
+      if (!item.empty())
+      {
+        names.push_back(item);
+      }
+    }
+
+    return names;
+  }
+
+  [[nodiscard]] static std::vector<size_t> parse_list(std::string const& value)
+  {
+    std::vector<size_t> list;
+    std::stringstream ss{value};
+    std::string item;
+
+    while (std::getline(ss, item, ','))
+    {
+      if (!item.empty())
+      {
+        list.push_back(std::stoull(item));
+      }
+    }
+
+    return list;
+  }
+
+private:
+  std::map<std::string, std::string> _values;
+};
+
+/**
+ * An element of SIZE bytes carrying a sequence number and a value
+ */
+template <size_t SIZE>
+struct Payload
+{
+  static_assert((SIZE >= 2 * sizeof(size_t)) && (SIZE % sizeof(size_t) == 0), "Invalid payload size");
+
+  Payload() = default;
+  Payload(size_t sequence, size_t value) : words{sequence, value} {}
+
+  [[nodiscard]] size_t sequence() const noexcept { return words[0]; }
+  [[nodiscard]] size_t value() const noexcept { return words[1]; }
+
+  std::array<size_t, SIZE / sizeof(size_t)> words{};
+};
+
+/**
+ * Pins the calling thread to a cpu
+ * @return false when the thread could not be pinned
+ */
+inline bool pin_thread(size_t cpu)
+{
+#if defined(__linux__)
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(cpu, &cpuset);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) == 0;
+#else
+  (void)cpu;
+  return false;
+#endif
+}
+
+/**
+ * Where the consumers run relative to the producer
+ */
+enum class Topology
+{
+  /** The threads are not pinned **/
+  None,
+  /** Explicit list of cpus given with --cores, the producer first **/
+  Cores,
+  /** The first consumer on the hyper thread sibling of the producer **/
+  Sibling,
+  /** The consumers on other physical cores of the producer socket **/
+  SameSocket,
+  /** The consumers on another socket **/
+  CrossSocket
+};
+
+inline Topology parse_topology(std::string const& value)
+{
+  if (value == "none")
+  {
+    return Topology::None;
+  }
+  if (value == "sibling")
+  {
+    return Topology::Sibling;
+  }
+  if (value == "socket")
+  {
+    return Topology::SameSocket;
+  }
+  if (value == "cross")
+  {
+    return Topology::CrossSocket;
+  }
+
+  throw std::runtime_error("Unknown topology " + value + ", expected none, sibling, socket or cross");
+}
+
+inline char const* to_string(Topology topology)
+{
+  switch (topology)
+  {
+  case Topology::None:
+    return "none";
+  case Topology::Cores:
+    return "cores";
+  case Topology::Sibling:
+    return "sibling";
+  case Topology::SameSocket:
+    return "socket";
+  case Topology::CrossSocket:
+    return "cross";
+  }
+
+  return "unknown";
+}
+
+struct CpuInfo
+{
+  size_t cpu;
+  size_t core_id;
+  size_t package_id;
+};
+
+/**
+ * @return the cpus the process is allowed to run on, which are online, from sched_getaffinity on
+ * linux, with their topology read from /sys/devices/system/cpu
+ */
+inline std::vector<CpuInfo> list_cpus()
+{
+  std::vector<size_t> allowed;
+
+#if defined(__linux__)
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+
+  if (sched_getaffinity(0, sizeof(cpu_set_t), &cpuset) == 0)
+  {
+    for (size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+      if (CPU_ISSET(cpu, &cpuset))
+      {
+        allowed.push_back(cpu);
+      }
+    }
+  }
+#endif
+
+  if (allowed.empty())
+  {
+    allowed.resize(std::max(1u, std::thread::hardware_concurrency()));
+    std::iota(allowed.begin(), allowed.end(), size_t{0});
+  }
+
+  std::vector<CpuInfo> cpus;
+
+  for (size_t cpu : allowed)
+  {
+    std::string const dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+    std::ifstream core_file{dir + "core_id"};
+    std::ifstream package_file{dir + "physical_package_id"};
+
+    CpuInfo info{cpu, cpu, 0};
+
+    if (core_file && package_file)
+    {
+      core_file >> info.core_id;
+      package_file >> info.package_id;
+    }
+
+    cpus.push_back(info);
+  }
+
+  return cpus;
+}
+
+/**
+ * Selects the cpus of the producer and of each consumer
+ * @param topology how to place the consumers relative to the producer
+ * @param consumers number of consumer threads
+ * @param cores the cpus given with --cores for Topology::Cores, the producer first
+ * @return the producer cpu followed by a cpu per consumer, or empty for Topology::None
+ */
+inline std::vector<size_t> select_cpus(Topology topology, size_t consumers, std::vector<size_t> const& cores)
+{
+  if (topology == Topology::None)
+  {
+    return {};
+  }
+
+  if (topology == Topology::Cores)
+  {
+    if (cores.size() < consumers + 1)
+    {
+      throw std::runtime_error("--cores needs a cpu for the producer and each consumer");
+    }
+
+    return std::vector<size_t>(cores.begin(), cores.begin() + static_cast<std::ptrdiff_t>(consumers + 1));
+  }
+
+  std::vector<CpuInfo> const cpus = list_cpus();
+
+  // the cpus the consumers can use with the producer on the given cpu, in order of preference
+  auto candidates_for = [&cpus, topology](CpuInfo const& producer)
+  {
+    std::vector<size_t> candidates;
+
+    for (CpuInfo const& info : cpus)
+    {
+      if (info.cpu == producer.cpu)
+      {
+        continue;
+      }
+
+      bool const same_core = (info.package_id == producer.package_id) && (info.core_id == producer.core_id);
+      bool const same_socket = info.package_id == producer.package_id;
+
+      if (((topology == Topology::Sibling) && same_core) || ((topology == Topology::SameSocket) && same_socket && !same_core) ||
+          ((topology == Topology::CrossSocket) && !same_socket))
+      {
+        candidates.push_back(info.cpu);
+      }
+    }
+
+    if ((topology == Topology::Sibling) && !candidates.empty())
+    {
+      // the first consumer shares the core of the producer, the others go to the rest of the socket
+      for (CpuInfo const& info : cpus)
+      {
+        if ((info.package_id == producer.package_id) && (info.core_id != producer.core_id))
+        {
+          candidates.push_back(info.cpu);
+        }
+      }
+    }
+
+    return candidates;
+  };
+
+  // the producer goes to the first allowed cpu the topology can be built around
+  bool any_sibling = false;
+
+  for (CpuInfo const& producer : cpus)
+  {
+    std::vector<size_t> const candidates = candidates_for(producer);
+    any_sibling = any_sibling || !candidates.empty();
+
+    if (candidates.size() >= consumers)
+    {
+      std::vector<size_t> selected{producer.cpu};
+      selected.insert(selected.end(), candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(consumers));
+      return selected;
+    }
+  }
+
+  if ((topology == Topology::Sibling) && !any_sibling)
+  {
+    throw std::runtime_error("No allowed cpu has a hyper thread sibling");
+  }
+
+  throw std::runtime_error(std::string{"Not enough cpus for the "} + to_string(topology) + " topology with " +
+                           std::to_string(consumers) + " consumers");
+}
+
+/**
+ * Pins the calling thread to cpus[index] when cpus were selected
+ */
+inline void pin_thread(std::vector<size_t> const& cpus, size_t index)
+{
+  if ((index < cpus.size()) && !pin_thread(cpus[index]))
+  {
+    std::cerr << "failed to pin thread to cpu " << cpus[index] << std::endl;
+  }
+}
+
+struct Summary
+{
+  double mean{0};
+  double median{0};
+  double p99{0};
+  double p999{0};
+  double min{0};
+  double max{0};
+  double stddev{0};
+};
+
+/**
+ * @return the nearest rank percentile of sorted samples
+ */
+inline double percentile(std::vector<double> const& sorted, double p)
+{
+  if (sorted.empty())
+  {
+    return 0;
+  }
+
+  size_t const rank = static_cast<size_t>(std::ceil((p / 100.0) * static_cast<double>(sorted.size())));
+  return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+inline Summary summarize(std::vector<double> samples)
+{
+  Summary summary;
+
+  if (samples.empty())
+  {
+    return summary;
+  }
+
+  std::sort(samples.begin(), samples.end());
+
+  summary.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+  summary.median = percentile(samples, 50.0);
+  summary.p99 = percentile(samples, 99.0);
+  summary.p999 = percentile(samples, 99.9);
+  summary.min = samples.front();
+  summary.max = samples.back();
+
+  double variance = 0;
+  for (double sample : samples)
+  {
+    variance += (sample - summary.mean) * (sample - summary.mean);
+  }
+  summary.stddev = std::sqrt(variance / static_cast<double>(samples.size()));
+
+  return summary;
+}
+
+/**
+ * A row of the report, the parameters as ordered key value pairs followed by the summary
+ */
+struct Result
+{
+  std::vector<std::pair<std::string, std::string>> params;
+  std::string unit;
+  size_t samples{0};
+  Summary summary;
+};
+
+/**
+ * Collects the results and writes them as CSV or JSON
+ */
+class Report
+{
+public:
+  void add(Result result) { _results.push_back(std::move(result)); }
+
+  [[nodiscard]] std::vector<Result> const& results() const noexcept { return _results; }
+
+  void write_csv(std::ostream& os) const
+  {
+    if (_results.empty())
+    {
+      return;
+    }
+
+    for (auto const& param : _results.front().params)
+    {
+      os << param.first << ',';
+    }
+    os << "unit,samples,mean,median,p99,p99.9,min,max,stddev\n";
+
+    for (Result const& result : _results)
+    {
+      for (auto const& param : result.params)
+      {
+        os << param.second << ',';
+      }
+
+      Summary const& s = result.summary;
+      os << result.unit << ',' << result.samples << ',' << s.mean << ',' << s.median << ',' << s.p99 << ',' << s.p999
+         << ',' << s.min << ',' << s.max << ',' << s.stddev << '\n';
+    }
+  }
+
+  /**
+   * Writes a table with a row per result, for reading in a terminal
+   */
+  void write_table(std::ostream& os) const
+  {
+    if (_results.empty())
+    {
+      return;
+    }
+
+    std::vector<std::string> header;
+    for (auto const& param : _results.front().params)
+    {
+      header.push_back(param.first);
+    }
+    for (char const* column : {"unit", "median", "p99", "p99.9", "mean", "stddev"})
+    {
+      header.emplace_back(column);
+    }
+
+    std::vector<std::vector<std::string>> rows;
+    for (Result const& result : _results)
+    {
+      std::vector<std::string> row;
+      for (auto const& param : result.params)
+      {
+        row.push_back(param.second);
+      }
+
+      Summary const& s = result.summary;
+      row.push_back(result.unit);
+      for (double value : {s.median, s.p99, s.p999, s.mean, s.stddev})
+      {
+        std::ostringstream oss;
+        oss << static_cast<uint64_t>(value + 0.5);
+        row.push_back(oss.str());
+      }
+
+      rows.push_back(std::move(row));
+    }
+
+    std::vector<size_t> widths;
+    for (std::string const& column : header)
+    {
+      widths.push_back(column.size());
+    }
+    for (auto const& row : rows)
+    {
+      for (size_t i = 0; i < row.size(); ++i)
+      {
+        widths[i] = std::max(widths[i], row[i].size());
+      }
+    }
+
+    auto write_row = [&os, &widths](std::vector<std::string> const& row)
+    {
+      os << '|';
+      for (size_t i = 0; i < row.size(); ++i)
+      {
+        os << ' ' << row[i] << std::string(widths[i] - row[i].size(), ' ') << " |";
+      }
+      os << '\n';
+    };
+
+    write_row(header);
+
+    os << '|';
+    for (size_t width : widths)
+    {
+      os << std::string(width + 2, '-') << '|';
+    }
+    os << '\n';
+
+    for (auto const& row : rows)
+    {
+      write_row(row);
+    }
+  }
+
+  void write_json(std::ostream& os, std::vector<std::pair<std::string, std::string>> const& context) const
+  {
+    os << "{\n  \"context\": {";
+    for (size_t i = 0; i < context.size(); ++i)
+    {
+      os << (i ? ", " : "") << '"' << context[i].first << "\": \"" << context[i].second << '"';
+    }
+    os << "},\n  \"benchmarks\": [\n";
+
+    for (size_t r = 0; r < _results.size(); ++r)
+    {
+      Result const& result = _results[r];
+      os << "    {";
+
+      for (auto const& param : result.params)
+      {
+        os << '"' << param.first << "\": \"" << param.second << "\", ";
+      }
+
+      Summary const& s = result.summary;
+      os << "\"unit\": \"" << result.unit << "\", \"samples\": " << result.samples << ", \"mean\": " << s.mean
+         << ", \"median\": " << s.median << ", \"p99\": " << s.p99 << ", \"p99.9\": " << s.p999 << ", \"min\": " << s.min
+         << ", \"max\": " << s.max << ", \"stddev\": " << s.stddev << '}' << ((r + 1 < _results.size()) ? "," : "") << '\n';
+    }
+
+    os << "  ]\n}\n";
+  }
+
+  /**
+   * Writes the report to --output, or to stdout, in the --format csv, json or table
+   */
+  void write(Options const& options, std::vector<std::pair<std::string, std::string>> const& context,
+             std::string const& default_format = "csv") const
+  {
+    std::string const format = options.get("format", default_format);
+    std::string const output = options.get("output", std::string{});
+
+    std::ofstream file;
+    if (!output.empty())
+    {
+      file.open(output);
+      if (!file)
+      {
+        throw std::runtime_error("Failed to open " + output);
+      }
+    }
+
+    write(output.empty() ? std::cout : file, format, context);
+  }
+
+  void write(std::ostream& os, std::string const& format, std::vector<std::pair<std::string, std::string>> const& context) const
+  {
+    if (format == "json")
+    {
+      write_json(os, context);
+    }
+    else if (format == "csv")
+    {
+      write_csv(os);
+    }
+    else if (format == "table")
+    {
+      write_table(os);
+    }
+    else
+    {
+      throw std::runtime_error("Unknown format " + format + ", expected csv, json or table");
+    }
+  }
+
+private:
+  std::vector<Result> _results;
+};
+} // namespace bench
@@ -0,0 +1,413 @@
+#include "lockfree_queues/latency_histogram.h"
+#include "lockfree_queues/sp_broadcast_queue.h"
+#include "lockfree_queues/spsc_queue.h"
+
+#include "benchmark_utils.h"
+#include "reference_queues.h"
+
+#if defined(LOCKFREE_QUEUES_HAS_BOOST_LOCKFREE)
+  #include <boost/lockfree/spsc_queue.hpp>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Compares the SPBroadcastQueue with one reader against other single producer ring designs, under
+ * the same element sizes, capacity and thread pinning. Each queue runs a throughput benchmark and
+ * a round trip time benchmark where two queues of the same type ping pong an element.
+ *
+ * Options, lists are comma separated:
+ *   --queues=...               defaults to all the queues built in
+ *   --capacity=65536           queue capacity, a power of two
+ *   --element-sizes=16,64,256  element sizes in bytes, from 16, 64, 256 and 1024
+ *   --runs=10                  repetitions of each configuration
+ *   --iterations=10000000      elements per throughput run
+ *   --rtt-iterations=100000    round trips per rtt run
+ *   --topology=none            none, sibling, socket or cross, where the consumer runs
+ *   --cores=0,2                explicit cpus instead, the producer first
+ *   --format=table             table, csv or json
+ *   --output=file              defaults to stdout
+ */
+
+/**
+ * The queues under test share the same interface: try_emplace(), front() and pop()
+ */
+template <typename T>
+class SPBroadcastQueueAdapter
+{
+public:
+  static constexpr char const* NAME = "SPBroadcastQueue";
+
+  explicit SPBroadcastQueueAdapter(size_t capacity) : _queue(capacity), _reader_id(_queue.subscribe()) {}
+
+  template <typename... Args>
+  [[gnu::always_inline, nodiscard]] bool try_emplace(Args&&... args)
+  {
+    return _queue.try_emplace(std::forward<Args>(args)...);
+  }
+
+  [[gnu::always_inline, nodiscard]] T const* front() noexcept { return _queue.front(_reader_id); }
+  [[gnu::always_inline]] void pop() noexcept { _queue.pop(_reader_id); }
+
+private:
+  lockfree_queues::SPBroadcastQueue<T> _queue;
+  size_t _reader_id;
+};
+
+template <typename T>
+class SPSCQueueAdapter
+{
+public:
+  static constexpr char const* NAME = "SPSCQueue";
+
+  explicit SPSCQueueAdapter(size_t capacity) : _queue(capacity) {}
+
+  template <typename... Args>
+  [[gnu::always_inline, nodiscard]] bool try_emplace(Args&&... args)
+  {
+    return _queue.try_emplace(std::forward<Args>(args)...);
+  }
+
+  [[gnu::always_inline, nodiscard]] T const* front() noexcept { return _queue.front(); }
+  [[gnu::always_inline]] void pop() noexcept { _queue.pop(); }
+
+private:
+  lockfree_queues::SPSCQueue<T> _queue;
+};
+
+template <typename T>
+class RigtorpSPSCQueueAdapter : public bench::RigtorpSPSCQueue<T>
+{
+public:
+  static constexpr char const* NAME = "RigtorpSPSCQueue";
+  using bench::RigtorpSPSCQueue<T>::RigtorpSPSCQueue;
+};
+
+template <typename T>
+class DisruptorRingAdapter : public bench::DisruptorRing<T>
+{
+public:
+  static constexpr char const* NAME = "DisruptorRing";
+  using bench::DisruptorRing<T>::DisruptorRing;
+};
+
+#if defined(LOCKFREE_QUEUES_HAS_BOOST_LOCKFREE)
+template <typename T>
+class BoostSPSCQueueAdapter
+{
+public:
+  static constexpr char const* NAME = "boost::lockfree::spsc_queue";
+
+  explicit BoostSPSCQueueAdapter(size_t capacity) : _queue(capacity) {}
+
+  template <typename... Args>
+  [[gnu::always_inline, nodiscard]] bool try_emplace(Args&&... args)
+  {
+    return _queue.push(T(std::forward<Args>(args)...));
+  }
+
+  [[gnu::always_inline, nodiscard]] T const* front() noexcept
+  {
+    return (_queue.read_available() != 0) ? &_queue.front() : nullptr;
+  }
+
+  [[gnu::always_inline]] void pop() noexcept { _queue.pop(); }
+
+private:
+  boost::lockfree::spsc_queue<T> _queue;
+};
+#endif
+
+struct Settings
+{
+  size_t capacity;
+  size_t runs;
+  size_t iterations;
+  size_t rtt_iterations;
+  std::vector<size_t> cpus;
+};
+
+template <typename Queue, typename T>
+double run_ops(Settings const& settings)
+{
+  auto q = std::make_unique<Queue>(settings.capacity);
+  size_t const iterations = settings.iterations;
+  size_t total_objects{0};
+  std::atomic<bool> ready{false};
+
+  std::thread reader_thread{[&q, &total_objects, &ready, &settings, iterations]
+                            {
+                              bench::pin_thread(settings.cpus, 1);
+                              ready.store(true);
+
+                              size_t n = 0;
+                              while (n < (iterations - 1))
+                              {
+                                T const* item = q->front();
+                                while (!item)
+                                {
+                                  item = q->front();
+                                }
+
+                                total_objects += item->value();
+                                n = item->sequence();
+
+                                q->pop();
+                              }
+                            }};
+
+  bench::pin_thread(settings.cpus, 0);
+
+  // the start up and the pinning of the reader are not measured
+  while (!ready.load())
+  {
+    std::this_thread::yield();
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < iterations; ++i)
+  {
+    while (!q->try_emplace(i, 1u))
+      ;
+  }
+
+  reader_thread.join();
+
+  auto stop = std::chrono::steady_clock::now();
+
+  return static_cast<double>(iterations) * 1000000.0 /
+    static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+}
+
+template <typename Queue, typename T>
+void run_rtt(Settings const& settings, lockfree_queues::TscClock const& clock, std::vector<double>& samples)
+{
+  auto q1 = std::make_unique<Queue>(settings.capacity);
+  auto q2 = std::make_unique<Queue>(settings.capacity);
+  size_t const iterations = settings.rtt_iterations;
+
+  auto t = std::thread(
+    [&q1, &q2, &settings, iterations]
+    {
+      bench::pin_thread(settings.cpus, 1);
+
+      for (size_t i = 0; i < iterations; ++i)
+      {
+        while (!q1->front())
+          ;
+
+        while (!q2->try_emplace(*q1->front()))
+          ;
+        q1->pop();
+      }
+    });
+
+  bench::pin_thread(settings.cpus, 0);
+
+  // no allocation in the measured loop
+  samples.reserve(samples.size() + iterations);
+
+  for (size_t i = 0; i < iterations; ++i)
+  {
+    uint64_t const start = clock.now();
+
+    while (!q1->try_emplace(i, 1u))
+      ;
+
+    while (!q2->front())
+      ;
+    q2->pop();
+
+    samples.push_back(static_cast<double>(clock.to_ns(clock.now() - start)));
+  }
+
+  t.join();
+}
+
+template <template <typename> class Queue, size_t SIZE>
+void run_queue(Settings const& settings, lockfree_queues::TscClock const& clock, bench::Report& ops_report,
+               bench::Report& rtt_report)
+{
+  using T = bench::Payload<SIZE>;
+
+  std::vector<double> ops_samples;
+  std::vector<double> rtt_samples;
+  ops_samples.reserve(settings.runs);
+  rtt_samples.reserve(settings.runs * settings.rtt_iterations);
+
+  for (size_t run = 0; run < settings.runs; ++run)
+  {
+    ops_samples.push_back(run_ops<Queue<T>, T>(settings));
+    run_rtt<Queue<T>, T>(settings, clock, rtt_samples);
+  }
+
+  bench::Result ops;
+  ops.params = {{"queue", Queue<T>::NAME}, {"element_size", std::to_string(SIZE)}};
+  ops.unit = "ops/ms";
+  ops.samples = ops_samples.size();
+  ops.summary = bench::summarize(std::move(ops_samples));
+
+  bench::Result rtt;
+  rtt.params = ops.params;
+  rtt.unit = "ns";
+  rtt.samples = rtt_samples.size();
+  rtt.summary = bench::summarize(std::move(rtt_samples));
+
+  std::cerr << Queue<T>::NAME << " element_size: " << SIZE << ", median: " << ops.summary.median
+            << " ops/ms, median RTT: " << rtt.summary.median << " ns" << std::endl;
+
+  ops_report.add(std::move(ops));
+  rtt_report.add(std::move(rtt));
+}
+
+template <template <typename> class Queue>
+void run_queue(std::vector<std::string> const& queues, std::vector<size_t> const& element_sizes, Settings const& settings,
+               lockfree_queues::TscClock const& clock, bench::Report& ops_report, bench::Report& rtt_report)
+{
+  if (std::find(queues.begin(), queues.end(), Queue<bench::Payload<16>>::NAME) == queues.end())
+  {
+    return;
+  }
+
+  for (size_t element_size : element_sizes)
+  {
+    switch (element_size)
+    {
+    case 16:
+      run_queue<Queue, 16>(settings, clock, ops_report, rtt_report);
+      break;
+    case 64:
+      run_queue<Queue, 64>(settings, clock, ops_report, rtt_report);
+      break;
+    case 256:
+      run_queue<Queue, 256>(settings, clock, ops_report, rtt_report);
+      break;
+    case 1024:
+      run_queue<Queue, 1024>(settings, clock, ops_report, rtt_report);
+      break;
+    default:
+      throw std::runtime_error("Unsupported element size " + std::to_string(element_size));
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  try
+  {
+    bench::Options const options{argc, argv};
+
+    std::vector<std::string> queues{SPBroadcastQueueAdapter<bench::Payload<16>>::NAME, SPSCQueueAdapter<bench::Payload<16>>::NAME,
+                                    RigtorpSPSCQueueAdapter<bench::Payload<16>>::NAME,
+                                    DisruptorRingAdapter<bench::Payload<16>>::NAME};
+#if defined(LOCKFREE_QUEUES_HAS_BOOST_LOCKFREE)
+    queues.emplace_back(BoostSPSCQueueAdapter<bench::Payload<16>>::NAME);
+#endif
+
+    if (options.has("queues"))
+    {
+      std::vector<std::string> selected;
+      std::stringstream ss{options.get("queues", std::string{})};
+      std::string item;
+
+      while (std::getline(ss, item, ','))
+      {
+        if (std::find(queues.begin(), queues.end(), item) == queues.end())
+        {
+          throw std::runtime_error("Unknown queue " + item);
+        }
+
+        selected.push_back(item);
+      }
+
+      queues = selected;
+    }
+
+    std::vector<size_t> const element_sizes = options.get_list("element-sizes", {16, 64, 256});
+
+    Settings settings;
+    settings.capacity = options.get("capacity", size_t{65536});
+    settings.runs = options.get("runs", size_t{10});
+    settings.iterations = options.get("iterations", size_t{10000000});
+    settings.rtt_iterations = options.get("rtt-iterations", size_t{100000});
+
+    std::vector<size_t> const cores = options.get_list("cores", {});
+    bench::Topology const topology =
+      cores.empty() ? bench::parse_topology(options.get("topology", std::string{"none"})) : bench::Topology::Cores;
+    settings.cpus = bench::select_cpus(topology, 1, cores);
+
+    lockfree_queues::TscClock const clock;
+    bench::Report ops_report;
+    bench::Report rtt_report;
+
+    run_queue<SPBroadcastQueueAdapter>(queues, element_sizes, settings, clock, ops_report, rtt_report);
+    run_queue<SPSCQueueAdapter>(queues, element_sizes, settings, clock, ops_report, rtt_report);
+    run_queue<RigtorpSPSCQueueAdapter>(queues, element_sizes, settings, clock, ops_report, rtt_report);
+    run_queue<DisruptorRingAdapter>(queues, element_sizes, settings, clock, ops_report, rtt_report);
+#if defined(LOCKFREE_QUEUES_HAS_BOOST_LOCKFREE)
+    run_queue<BoostSPSCQueueAdapter>(queues, element_sizes, settings, clock, ops_report, rtt_report);
+#endif
+
+    std::vector<std::pair<std::string, std::string>> context{
+      {"topology", bench::to_string(topology)},
+      {"capacity", std::to_string(settings.capacity)},
+      {"runs", std::to_string(settings.runs)},
+      {"iterations", std::to_string(settings.iterations)},
+      {"rtt_iterations", std::to_string(settings.rtt_iterations)}};
+
+    std::string const format = options.get("format", std::string{"table"});
+    std::string const output = options.get("output", std::string{});
+
+    std::ofstream file;
+    if (!output.empty())
+    {
+      file.open(output);
+      if (!file)
+      {
+        throw std::runtime_error("Failed to open " + output);
+      }
+    }
+
+    std::ostream& os = output.empty() ? std::cout : file;
+
+    if (format == "table")
+    {
+      os << "Throughput (ops/ms)\n";
+      ops_report.write(os, format, context);
+      os << "\nLatency RTT (ns)\n";
+      rtt_report.write(os, format, context);
+    }
+    else
+    {
+      // a single report with a row per benchmark
+      bench::Report report;
+      for (auto const* source : {&ops_report, &rtt_report})
+      {
+        for (bench::Result result : source->results())
+        {
+          result.params.insert(result.params.begin(), {"benchmark", (source == &ops_report) ? "ops" : "rtt"});
+          report.add(std::move(result));
+        }
+      }
+
+      report.write(os, format, context);
+    }
+  }
+  catch (std::exception const& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
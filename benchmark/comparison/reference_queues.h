@@ -0,0 +1,191 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Minimal versions of well known ring buffer designs, vendored so the comparison benchmark does
+ * not need any dependency. They only implement what the benchmark needs.
+ */
+namespace bench
+{
+
+static constexpr size_t CACHE_LINE_SIZE{128u};
+
+/***
+ * A SPSC ring in the style of rigtorp::SPSCQueue: the read and write indexes live on their own
+ * cache lines and each side caches the index of the other side, reloading it only when the ring
+ * looks full or empty. One slot is left unused to tell a full ring from an empty one, and the
+ * capacity does not need to be a power of two.
+ */
+template <typename T>
+class RigtorpSPSCQueue
+{
+public:
+  explicit RigtorpSPSCQueue(size_t capacity)
+    : _capacity(capacity + 1), _slots(static_cast<T*>(::operator new(sizeof(T) * (_capacity + 2 * PADDING))))
+  {
+  }
+
+  ~RigtorpSPSCQueue()
+  {
+    while (front())
+    {
+      pop();
+    }
+
+    ::operator delete(_slots);
+  }
+
+  RigtorpSPSCQueue(RigtorpSPSCQueue const&) = delete;
+  RigtorpSPSCQueue& operator=(RigtorpSPSCQueue const&) = delete;
+
+  template <typename... Args>
+  [[gnu::always_inline, nodiscard]] bool try_emplace(Args&&... args)
+  {
+    size_t const write_idx = _write_idx.load(std::memory_order_relaxed);
+    size_t next_write_idx = write_idx + 1;
+
+    if (next_write_idx == _capacity)
+    {
+      next_write_idx = 0;
+    }
+
+    if (next_write_idx == _read_idx_cache)
+    {
+      _read_idx_cache = _read_idx.load(std::memory_order_acquire);
+
+      if (next_write_idx == _read_idx_cache)
+      {
+        return false;
+      }
+    }
+
+    ::new (static_cast<void*>(&_slots[write_idx + PADDING])) T(std::forward<Args>(args)...);
+    _write_idx.store(next_write_idx, std::memory_order_release);
+    return true;
+  }
+
+  [[gnu::always_inline, nodiscard]] T const* front() noexcept
+  {
+    size_t const read_idx = _read_idx.load(std::memory_order_relaxed);
+
+    if (read_idx == _write_idx_cache)
+    {
+      _write_idx_cache = _write_idx.load(std::memory_order_acquire);
+
+      if (read_idx == _write_idx_cache)
+      {
+        return nullptr;
+      }
+    }
+
+    return &_slots[read_idx + PADDING];
+  }
+
+  [[gnu::always_inline]] void pop() noexcept
+  {
+    size_t const read_idx = _read_idx.load(std::memory_order_relaxed);
+    _slots[read_idx + PADDING].~T();
+
+    size_t next_read_idx = read_idx + 1;
+    if (next_read_idx == _capacity)
+    {
+      next_read_idx = 0;
+    }
+
+    _read_idx.store(next_read_idx, std::memory_order_release);
+  }
+
+private:
+  /** Slots kept empty on both ends so the ring does not false share with adjacent allocations **/
+  static constexpr size_t PADDING = (CACHE_LINE_SIZE - 1) / sizeof(T) + 1;
+
+  size_t _capacity;
+  T* _slots;
+
+  alignas(CACHE_LINE_SIZE) std::atomic<size_t> _write_idx{0};
+  alignas(CACHE_LINE_SIZE) size_t _read_idx_cache{0};
+  alignas(CACHE_LINE_SIZE) std::atomic<size_t> _read_idx{0};
+  alignas(CACHE_LINE_SIZE) size_t _write_idx_cache{0};
+};
+
+/***
+ * A single producer, single consumer ring in the style of the LMAX Disruptor: the elements are
+ * preallocated and overwritten in place, the producer publishes by advancing a cursor sequence and
+ * is gated by the sequence of the consumer. The consumer processes everything published in a batch
+ * and only advances its sequence at the end of the batch.
+ */
+template <typename T>
+class DisruptorRing
+{
+  static_assert(std::is_default_constructible<T>::value, "The ring preallocates its elements");
+
+public:
+  explicit DisruptorRing(size_t capacity) : _capacity(capacity), _mask(capacity - 1), _ring(std::make_unique<T[]>(capacity))
+  {
+    if ((capacity == 0) || ((capacity & (capacity - 1)) != 0))
+    {
+      throw std::runtime_error{"capacity must be power of 2"};
+    }
+  }
+
+  DisruptorRing(DisruptorRing const&) = delete;
+  DisruptorRing& operator=(DisruptorRing const&) = delete;
+
+  template <typename... Args>
+  [[gnu::always_inline, nodiscard]] bool try_emplace(Args&&... args)
+  {
+    if ((_next_sequence - _gating_sequence_cache) == _capacity)
+    {
+      _gating_sequence_cache = _consumer_sequence.load(std::memory_order_acquire);
+
+      if ((_next_sequence - _gating_sequence_cache) == _capacity)
+      {
+        return false;
+      }
+    }
+
+    _ring[_next_sequence & _mask] = T(std::forward<Args>(args)...);
+    _cursor.store(++_next_sequence, std::memory_order_release);
+    return true;
+  }
+
+  [[gnu::always_inline, nodiscard]] T const* front() noexcept
+  {
+    if (_read_sequence == _available_sequence)
+    {
+      // the batch is done, release it to the producer and look for the next one
+      _consumer_sequence.store(_read_sequence, std::memory_order_release);
+      _available_sequence = _cursor.load(std::memory_order_acquire);
+
+      if (_read_sequence == _available_sequence)
+      {
+        return nullptr;
+      }
+    }
+
+    return &_ring[_read_sequence & _mask];
+  }
+
+  [[gnu::always_inline]] void pop() noexcept { ++_read_sequence; }
+
+private:
+  size_t _capacity;
+  size_t _mask;
+  std::unique_ptr<T[]> _ring;
+
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> _cursor{0};
+  alignas(CACHE_LINE_SIZE) uint64_t _next_sequence{0};
+  uint64_t _gating_sequence_cache{0};
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> _consumer_sequence{0};
+  alignas(CACHE_LINE_SIZE) uint64_t _read_sequence{0};
+  uint64_t _available_sequence{0};
+};
+} // namespace bench
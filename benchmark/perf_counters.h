@@ -0,0 +1,273 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+namespace bench
+{
+
+/**
+ * A hardware event to count, see perf_event_open(2)
+ */
+struct PerfEvent
+{
+  std::string name;
+  uint32_t type;
+  uint64_t config;
+};
+
+/***
+ * Counts hardware events of the calling thread with perf_event_open, around a measured region.
+ *
+ * Each event is opened on its own so an event the cpu or the kernel does not support, or that
+ * perf_event_paranoid forbids, is reported as unavailable without losing the others. When the
+ * kernel multiplexes the counters the values are scaled by the time each one was running.
+ *
+ * Create, start() and stop() the counters on the thread being measured.
+ */
+class PerfCounters
+{
+public:
+  /**
+   * @return cycles, instructions, L1D read misses and last level cache read misses
+   */
+  static std::vector<PerfEvent> default_events()
+  {
+#if defined(__linux__)
+    auto cache_event = [](uint64_t cache)
+    {
+      return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    };
+
+    return {{"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {"l1d_misses", PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_L1D)},
+            {"llc_misses", PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_LL)}};
+#else
+    return {};
+#endif
+  }
+
+  /**
+   * Parses model specific raw events, e.g. the HITM loads of Skylake server
+   * MEM_LOAD_L3_HIT_RETIRED.XSNP_HITM with --perf-raw=hitm:0x04d2
+   * @param value comma separated name:config pairs, the config in hex
+   */
+  static std::vector<PerfEvent> parse_raw_events(std::string const& value)
+  {
+    std::vector<PerfEvent> events;
+    std::stringstream ss{value};
+    std::string item;
+
+    while (std::getline(ss, item, ','))
+    {
+      size_t const colon = item.find(':');
+      if ((colon == std::string::npos) || (colon == 0) || (colon + 1 == item.size()))
+      {
+        throw std::runtime_error("Invalid raw perf event " + item + ", expected name:config");
+      }
+
+      std::string const config = item.substr(colon + 1);
+      uint64_t raw_config = 0;
+
+      try
+      {
+        size_t parsed = 0;
+        raw_config = std::stoull(config, &parsed, 16);
+
+        if (parsed != config.size())
+        {
+          throw std::invalid_argument(config);
+        }
+      }
+      catch (std::logic_error const&)
+      {
+        // std::stoull throws std::invalid_argument or std::out_of_range
+        throw std::runtime_error("Invalid raw perf event " + item + ", expected name:config with a hex config");
+      }
+
+#if defined(__linux__)
+      events.push_back({item.substr(0, colon), PERF_TYPE_RAW, raw_config});
+#else
+      (void)raw_config;
+#endif
+    }
+
+    return events;
+  }
+
+  explicit PerfCounters(std::vector<PerfEvent> events) : _events(std::move(events)), _fds(_events.size(), -1)
+  {
+#if defined(__linux__)
+    for (size_t i = 0; i < _events.size(); ++i)
+    {
+      perf_event_attr attr{};
+      attr.size = sizeof(perf_event_attr);
+      attr.type = _events[i].type;
+      attr.config = _events[i].config;
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      // the calling thread, on any cpu
+      _fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+#endif
+  }
+
+  ~PerfCounters()
+  {
+#if defined(__linux__)
+    for (int fd : _fds)
+    {
+      if (fd != -1)
+      {
+        close(fd);
+      }
+    }
+#endif
+  }
+
+  PerfCounters(PerfCounters const&) = delete;
+  PerfCounters& operator=(PerfCounters const&) = delete;
+
+  void start() noexcept
+  {
+#if defined(__linux__)
+    for (int fd : _fds)
+    {
+      if (fd != -1)
+      {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+#endif
+  }
+
+  void stop() noexcept
+  {
+#if defined(__linux__)
+    for (int fd : _fds)
+    {
+      if (fd != -1)
+      {
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      }
+    }
+#endif
+  }
+
+  /**
+   * @return the count of each event, or -1 when the event is unavailable
+   */
+  [[nodiscard]] std::vector<double> read() const
+  {
+    std::vector<double> values(_fds.size(), -1.0);
+
+#if defined(__linux__)
+    for (size_t i = 0; i < _fds.size(); ++i)
+    {
+      uint64_t data[3]; // value, time enabled, time running
+
+      if ((_fds[i] == -1) || (::read(_fds[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) || (data[2] == 0))
+      {
+        continue;
+      }
+
+      values[i] = static_cast<double>(data[0]) * static_cast<double>(data[1]) / static_cast<double>(data[2]);
+    }
+#endif
+
+    return values;
+  }
+
+  /**
+   * Prints each event divided by the operations, and instructions per cycle when both are counted
+   */
+  void print(std::ostream& os, std::string const& thread_name, size_t operations) const
+  {
+    std::vector<double> const values = read();
+    double cycles = -1;
+    double instructions = -1;
+
+    os << thread_name << ':';
+
+    for (size_t i = 0; i < _events.size(); ++i)
+    {
+      os << ' ' << _events[i].name << "/op: ";
+
+      if (values[i] < 0)
+      {
+        os << "n/a";
+      }
+      else
+      {
+        os << std::fixed << std::setprecision(3) << (values[i] / static_cast<double>(operations));
+      }
+
+      if (_events[i].name == "cycles")
+      {
+        cycles = values[i];
+      }
+      else if (_events[i].name == "instructions")
+      {
+        instructions = values[i];
+      }
+    }
+
+    if ((cycles > 0) && (instructions >= 0))
+    {
+      os << " ipc: " << std::fixed << std::setprecision(3) << (instructions / cycles);
+    }
+
+    os << std::defaultfloat << '\n';
+  }
+
+private:
+  std::vector<PerfEvent> _events;
+  std::vector<int> _fds;
+};
+
+/**
+ * @return the events requested on the command line, --perf for the default ones and
+ * --perf-raw=name:config,... for model specific ones, or none when the counters are not requested
+ */
+inline std::vector<PerfEvent> perf_events_from_args(int argc, char** argv)
+{
+  std::vector<PerfEvent> events;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string const arg{argv[i]};
+
+    if (arg == "--perf")
+    {
+      std::vector<PerfEvent> const defaults = PerfCounters::default_events();
+      events.insert(events.end(), defaults.begin(), defaults.end());
+    }
+    else if (arg.rfind("--perf-raw=", 0) == 0)
+    {
+      std::vector<PerfEvent> const raw = PerfCounters::parse_raw_events(arg.substr(11));
+      events.insert(events.end(), raw.begin(), raw.end());
+    }
+  }
+
+  return events;
+}
+} // namespace bench
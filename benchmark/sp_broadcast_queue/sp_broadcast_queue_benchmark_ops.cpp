@@ -1,7 +1,12 @@
 #include "lockfree_queues/sp_broadcast_queue.h"
 
+#include "perf_counters.h"
+
+#include <atomic>
 #include <chrono>
 #include <iostream>
+#include <sstream>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -11,7 +16,11 @@ struct TestObj
   size_t y;
 };
 
-int main()
+/**
+ * Pass --perf to print hardware counters per operation, and --perf-raw=name:config for model
+ * specific events, see perf_counters.h
+ */
+int main(int argc, char** argv)
 {
   size_t const queue_size = 65536;
   size_t const reader_batch_size = 4;
@@ -24,13 +33,39 @@ int main()
   std::vector<std::thread> reader_threads;
   std::vector<size_t> total_objects(MAX_READERS, 0);
 
+  std::vector<bench::PerfEvent> perf_events;
+  try
+  {
+    perf_events = bench::perf_events_from_args(argc, argv);
+  }
+  catch (std::exception const& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  std::vector<std::string> reader_perf(MAX_READERS);
+
+  // the readers subscribe, then wait for the producer so that their counters cover the same window
+  std::atomic<size_t> ready{0};
+  std::atomic<bool> go{false};
+
   for (size_t tid = 0; tid < MAX_READERS; ++tid)
   {
     reader_threads.emplace_back(
-      [&q, &total_objects, tid, iterations]
+      [&q, &total_objects, &perf_events, &reader_perf, &ready, &go, tid, iterations]
       {
         size_t cid = q.subscribe();
 
+        bench::PerfCounters perf{perf_events};
+        ready.fetch_add(1);
+
+        while (!go.load(std::memory_order_acquire))
+        {
+          std::this_thread::yield();
+        }
+
+        perf.start();
+
         size_t n = 0;
         while (n < (iterations - 1))
         {
@@ -45,10 +80,27 @@ int main()
 
           q.pop(cid);
         }
+
+        perf.stop();
+
+        std::ostringstream oss;
+        perf.print(oss, "reader " + std::to_string(tid), iterations);
+        reader_perf[tid] = oss.str();
       });
   }
 
+  bench::PerfCounters producer_perf{perf_events};
+
+  while (ready.load() != MAX_READERS)
+  {
+    std::this_thread::yield();
+  }
+
+  // the counters are started and stopped outside of the timed window, their ioctl calls are not
+  // part of the measurement
+  producer_perf.start();
   auto start = std::chrono::steady_clock::now();
+  go.store(true, std::memory_order_release);
 
   for (size_t i = 0; i < iterations; ++i)
   {
@@ -62,8 +114,20 @@ int main()
   }
 
   auto stop = std::chrono::steady_clock::now();
+  producer_perf.stop();
   std::cout << iterations * 1000000 /
       std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count()
             << " ops/ms, total_duration: "
             << std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count() << " ms";
+
+  if (!perf_events.empty())
+  {
+    std::cout << std::endl;
+    producer_perf.print(std::cout, "producer", iterations);
+
+    for (auto const& perf : reader_perf)
+    {
+      std::cout << perf;
+    }
+  }
 }
\ No newline at end of file
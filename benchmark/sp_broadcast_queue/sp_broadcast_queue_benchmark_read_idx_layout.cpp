@@ -0,0 +1,88 @@
+#include "lockfree_queues/sp_broadcast_queue.h"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/**
+ * Compares the throughput of the packed and padded read index layouts. The more often the readers
+ * commit their read index, i.e. the higher the reader_batch_size, the more the padded layout helps
+ */
+
+struct TestObj
+{
+  size_t x;
+  size_t y;
+};
+
+constexpr size_t MAX_READERS = 6;
+
+template <lockfree_queues::ReadIndexLayout READ_INDEX_LAYOUT>
+void run(char const* layout, size_t reader_batch_size)
+{
+  size_t const queue_size = 65536;
+  int64_t const iterations = 10000000;
+
+  using queue_t =
+    lockfree_queues::SPBroadcastQueue<TestObj, MAX_READERS, std::allocator<TestObj>, lockfree_queues::BusySpinWaitStrategy,
+                                      lockfree_queues::OverflowPolicy::Block, lockfree_queues::PublishPolicy::WriteIndex, READ_INDEX_LAYOUT>;
+
+  auto q = std::make_unique<queue_t>(queue_size, reader_batch_size);
+
+  std::vector<std::thread> reader_threads;
+  std::vector<size_t> total_objects(MAX_READERS, 0);
+
+  for (size_t tid = 0; tid < MAX_READERS; ++tid)
+  {
+    size_t const cid = q->subscribe();
+
+    reader_threads.emplace_back(
+      [&q, &total_objects, tid, cid, iterations]
+      {
+        size_t n = 0;
+        while (n < (iterations - 1))
+        {
+          TestObj const* item = q->front(cid);
+          while (!item)
+          {
+            item = q->front(cid);
+          }
+
+          total_objects[tid] += item->y;
+          n = item->x;
+
+          q->pop(cid);
+        }
+      });
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < iterations; ++i)
+  {
+    while (!q->try_emplace(i, 1u))
+      ;
+  }
+
+  for (auto& rt : reader_threads)
+  {
+    rt.join();
+  }
+
+  auto stop = std::chrono::steady_clock::now();
+  std::cout << layout << " reader_batch_size: " << reader_batch_size << ", "
+            << iterations * 1000000 / std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count()
+            << " ops/ms, total_duration: "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count() << " ms" << std::endl;
+}
+
+int main()
+{
+  for (size_t reader_batch_size : {4u, 1024u, 65536u})
+  {
+    run<lockfree_queues::ReadIndexLayout::Packed>("packed", reader_batch_size);
+    run<lockfree_queues::ReadIndexLayout::Padded>("padded", reader_batch_size);
+  }
+}
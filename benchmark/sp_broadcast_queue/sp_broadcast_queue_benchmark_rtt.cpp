@@ -1,7 +1,11 @@
 #include "lockfree_queues/sp_broadcast_queue.h"
 
+#include "perf_counters.h"
+
 #include <chrono>
 #include <iostream>
+#include <sstream>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -11,7 +15,11 @@ struct TestObj
   size_t y;
 };
 
-int main()
+/**
+ * Pass --perf to print hardware counters per round trip, and --perf-raw=name:config for model
+ * specific events, see perf_counters.h
+ */
+int main(int argc, char** argv)
 {
   size_t const queue_size = 65536;
   size_t const reader_batch_size = 4;
@@ -21,14 +29,29 @@ int main()
 
   std::vector<size_t> total_objects(MAX_READERS, 0);
 
+  std::vector<bench::PerfEvent> perf_events;
+  try
+  {
+    perf_events = bench::perf_events_from_args(argc, argv);
+  }
+  catch (std::exception const& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  std::string echo_perf;
+
   lockfree_queues::SPBroadcastQueue<TestObj, MAX_READERS> q1{queue_size, reader_batch_size};
   lockfree_queues::SPBroadcastQueue<TestObj, MAX_READERS> q2{queue_size, reader_batch_size};
 
   auto t = std::thread(
-    [&q1, &q2, iterations]
+    [&q1, &q2, &perf_events, &echo_perf, iterations]
     {
       auto q1_cid = q1.subscribe();
 
+      bench::PerfCounters perf{perf_events};
+      perf.start();
+
       for (int i = 0; i < iterations; ++i)
       {
         while (!q1.front(q1_cid))
@@ -38,11 +61,23 @@ int main()
           ;
         q1.pop(q1_cid);
       }
+
+      perf.stop();
+
+      std::ostringstream oss;
+      perf.print(oss, "echo", iterations);
+      echo_perf = oss.str();
     });
 
   auto q2_cid = q2.subscribe();
 
+  bench::PerfCounters producer_perf{perf_events};
+
+  // the counters are started and stopped outside of the timed window, their ioctl calls are not
+  // part of the measurement
+  producer_perf.start();
   auto start = std::chrono::steady_clock::now();
+
   for (size_t i = 0; i < iterations; ++i)
   {
     while (!q1.try_emplace(i, 1u))
@@ -53,7 +88,15 @@ int main()
     q2.pop(q2_cid);
   }
   auto stop = std::chrono::steady_clock::now();
+  producer_perf.stop();
 
   t.join();
   std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / iterations << " ns RTT";
-}
\ No newline at end of file
+
+  if (!perf_events.empty())
+  {
+    std::cout << std::endl;
+    producer_perf.print(std::cout, "producer", iterations);
+    std::cout << echo_perf;
+  }
+}
@@ -0,0 +1,341 @@
+#include "lockfree_queues/latency_histogram.h"
+#include "lockfree_queues/sp_broadcast_queue.h"
+#include "lockfree_queues/utilities.h"
+
+#include "benchmark_utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Sweeps the throughput and the round trip time of the SPBroadcastQueue over reader counts,
+ * capacities, reader batch sizes and element sizes. Each configuration is repeated --runs times
+ * and summarised, throughput over the runs and round trip time over every round trip.
+ *
+ * The throughput benchmark sweeps the reader count at run time, so it uses a DYNAMIC_READERS
+ * queue rather than the compile time MAX_READERS layout, the max_readers column of the report
+ * says which one each result measured.
+ *
+ * Options, lists are comma separated:
+ *   --readers=1,2,4            reader counts of the throughput benchmark
+ *   --capacities=1024,65536    queue capacities
+ *   --batch-sizes=1,4,64       reader batch sizes, powers of two, the invalid combinations are skipped
+ *   --element-sizes=16,64,256  element sizes in bytes, from 16, 64, 256 and 1024
+ *   --runs=10                  repetitions of each configuration
+ *   --iterations=1000000       elements per throughput run
+ *   --rtt-iterations=100000    round trips per rtt run
+ *   --topology=none            none, sibling, socket or cross, where the consumers run
+ *   --cores=0,2,4              explicit cpus instead, the producer first
+ *   --benchmarks=ops,rtt       which benchmarks to run
+ *   --format=csv               csv, json or table
+ *   --output=file              defaults to stdout
+ */
+
+struct Config
+{
+  size_t readers;
+  size_t capacity;
+  size_t reader_batch_size;
+  size_t element_size;
+};
+
+struct Settings
+{
+  size_t runs;
+  size_t iterations;
+  size_t rtt_iterations;
+  bench::Topology topology;
+  std::vector<size_t> cores;
+};
+
+/**
+ * Checks the configuration the same way the queue does, so that an invalid value skips its
+ * combinations instead of aborting the whole sweep
+ * @return why the configuration is invalid, or an empty string
+ */
+std::string validate(Config const& config)
+{
+  // the queue rounds the capacity up the same way
+  size_t const capacity = std::max(size_t{16}, lockfree_queues::next_power_of_two(config.capacity));
+
+  if (config.readers == 0)
+  {
+    return "readers can not be zero";
+  }
+
+  if ((config.reader_batch_size == 0) || (config.reader_batch_size > capacity) ||
+      !lockfree_queues::is_power_of_two(capacity / config.reader_batch_size))
+  {
+    return "capacity / reader_batch_size must be a power of 2";
+  }
+
+  if ((config.element_size != 16) && (config.element_size != 64) && (config.element_size != 256) &&
+      (config.element_size != 1024))
+  {
+    return "unsupported element size";
+  }
+
+  return {};
+}
+
+template <size_t SIZE>
+double run_ops(Config const& config, Settings const& settings, std::vector<size_t> const& cpus)
+{
+  using queue_t = lockfree_queues::SPBroadcastQueue<bench::Payload<SIZE>, lockfree_queues::DYNAMIC_READERS>;
+
+  auto q = std::make_unique<queue_t>(config.capacity, config.readers, config.reader_batch_size);
+  size_t const iterations = settings.iterations;
+
+  std::vector<std::thread> reader_threads;
+  std::vector<size_t> total_objects(config.readers, 0);
+  std::atomic<size_t> ready{0};
+
+  for (size_t tid = 0; tid < config.readers; ++tid)
+  {
+    size_t const cid = q->subscribe();
+
+    reader_threads.emplace_back(
+      [&q, &total_objects, &ready, &cpus, tid, cid, iterations]
+      {
+        bench::pin_thread(cpus, tid + 1);
+        ready.fetch_add(1);
+
+        size_t n = 0;
+        while (n < (iterations - 1))
+        {
+          bench::Payload<SIZE> const* item = q->front(cid);
+          while (!item)
+          {
+            item = q->front(cid);
+          }
+
+          total_objects[tid] += item->value();
+          n = item->sequence();
+
+          q->pop(cid);
+        }
+      });
+  }
+
+  bench::pin_thread(cpus, 0);
+
+  while (ready.load() != config.readers)
+  {
+    std::this_thread::yield();
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < iterations; ++i)
+  {
+    while (!q->try_emplace(i, 1u))
+      ;
+  }
+
+  for (auto& rt : reader_threads)
+  {
+    rt.join();
+  }
+
+  auto stop = std::chrono::steady_clock::now();
+
+  return static_cast<double>(iterations) * 1000000.0 /
+    static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+}
+
+template <size_t SIZE>
+void run_rtt(Config const& config, Settings const& settings, std::vector<size_t> const& cpus,
+             lockfree_queues::TscClock const& clock, std::vector<double>& samples)
+{
+  using queue_t = lockfree_queues::SPBroadcastQueue<bench::Payload<SIZE>>;
+
+  auto q1 = std::make_unique<queue_t>(config.capacity, config.reader_batch_size);
+  auto q2 = std::make_unique<queue_t>(config.capacity, config.reader_batch_size);
+  size_t const iterations = settings.rtt_iterations;
+
+  size_t const q1_cid = q1->subscribe();
+  size_t const q2_cid = q2->subscribe();
+
+  auto t = std::thread(
+    [&q1, &q2, &cpus, q1_cid, iterations]
+    {
+      bench::pin_thread(cpus, 1);
+
+      for (size_t i = 0; i < iterations; ++i)
+      {
+        while (!q1->front(q1_cid))
+          ;
+
+        while (!q2->try_emplace(*q1->front(q1_cid)))
+          ;
+        q1->pop(q1_cid);
+      }
+    });
+
+  bench::pin_thread(cpus, 0);
+
+  // no allocation in the measured loop
+  samples.reserve(samples.size() + iterations);
+
+  for (size_t i = 0; i < iterations; ++i)
+  {
+    uint64_t const start = clock.now();
+
+    while (!q1->try_emplace(i, 1u))
+      ;
+
+    while (!q2->front(q2_cid))
+      ;
+    q2->pop(q2_cid);
+
+    samples.push_back(static_cast<double>(clock.to_ns(clock.now() - start)));
+  }
+
+  t.join();
+}
+
+template <size_t SIZE>
+bool run_config(std::string const& benchmark, Config const& config, Settings const& settings,
+                lockfree_queues::TscClock const& clock, bench::Report& report)
+{
+  if (config.element_size != SIZE)
+  {
+    return false;
+  }
+
+  std::vector<size_t> const cpus = bench::select_cpus(settings.topology, config.readers, settings.cores);
+
+  bench::Result result;
+  result.params = {{"benchmark", benchmark},
+                   {"readers", std::to_string(config.readers)},
+                   {"max_readers", (benchmark == "ops") ? "dynamic" : "1"},
+                   {"capacity", std::to_string(config.capacity)},
+                   {"reader_batch_size", std::to_string(config.reader_batch_size)},
+                   {"element_size", std::to_string(config.element_size)},
+                   {"topology", bench::to_string(settings.topology)}};
+
+  std::vector<double> samples;
+  samples.reserve((benchmark == "ops") ? settings.runs : settings.runs * settings.rtt_iterations);
+
+  for (size_t run = 0; run < settings.runs; ++run)
+  {
+    if (benchmark == "ops")
+    {
+      samples.push_back(run_ops<SIZE>(config, settings, cpus));
+    }
+    else
+    {
+      run_rtt<SIZE>(config, settings, cpus, clock, samples);
+    }
+  }
+
+  result.unit = (benchmark == "ops") ? "ops/ms" : "ns";
+  result.samples = samples.size();
+  result.summary = bench::summarize(std::move(samples));
+
+  std::cerr << benchmark << " readers: " << config.readers << ", capacity: " << config.capacity
+            << ", reader_batch_size: " << config.reader_batch_size << ", element_size: " << config.element_size
+            << ", median: " << result.summary.median << ' ' << result.unit << std::endl;
+
+  report.add(std::move(result));
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  try
+  {
+    bench::Options const options{argc, argv};
+
+    std::vector<size_t> const readers = options.get_list("readers", {1, 2, 4});
+    std::vector<size_t> const capacities = options.get_list("capacities", {1024, 65536});
+    std::vector<size_t> const batch_sizes = options.get_list("batch-sizes", {1, 4, 64});
+    std::vector<size_t> const element_sizes = options.get_list("element-sizes", {16, 64, 256});
+
+    Settings settings;
+    settings.runs = options.get("runs", size_t{10});
+    settings.iterations = options.get("iterations", size_t{1000000});
+    settings.rtt_iterations = options.get("rtt-iterations", size_t{100000});
+    settings.topology = bench::parse_topology(options.get("topology", std::string{"none"}));
+    settings.cores = options.get_list("cores", {});
+
+    if (!settings.cores.empty())
+    {
+      settings.topology = bench::Topology::Cores;
+    }
+
+    std::vector<std::string> const benchmarks = options.get_names("benchmarks", {"ops", "rtt"});
+
+    for (std::string const& benchmark : benchmarks)
+    {
+      if ((benchmark != "ops") && (benchmark != "rtt"))
+      {
+        throw std::runtime_error("Unknown benchmark " + benchmark + ", expected ops or rtt");
+      }
+    }
+
+    lockfree_queues::TscClock const clock;
+    bench::Report report;
+
+    for (std::string const benchmark : {"ops", "rtt"})
+    {
+      if (std::find(benchmarks.begin(), benchmarks.end(), benchmark) == benchmarks.end())
+      {
+        continue;
+      }
+
+      // the round trip is between a single producer and a single consumer
+      std::vector<size_t> const reader_counts = (benchmark == "ops") ? readers : std::vector<size_t>{1};
+
+      for (size_t reader_count : reader_counts)
+      {
+        for (size_t capacity : capacities)
+        {
+          for (size_t reader_batch_size : batch_sizes)
+          {
+            for (size_t element_size : element_sizes)
+            {
+              Config const config{reader_count, capacity, reader_batch_size, element_size};
+
+              std::string const invalid = validate(config);
+              if (!invalid.empty())
+              {
+                std::cerr << benchmark << " readers: " << config.readers << ", capacity: " << config.capacity
+                          << ", reader_batch_size: " << config.reader_batch_size
+                          << ", element_size: " << config.element_size << ", skipped: " << invalid << std::endl;
+                continue;
+              }
+
+              (void)(run_config<16>(benchmark, config, settings, clock, report) ||
+                     run_config<64>(benchmark, config, settings, clock, report) ||
+                     run_config<256>(benchmark, config, settings, clock, report) ||
+                     run_config<1024>(benchmark, config, settings, clock, report));
+            }
+          }
+        }
+      }
+    }
+
+    report.write(options,
+                 {{"queue", "SPBroadcastQueue"},
+                  {"cpus", std::to_string(std::thread::hardware_concurrency())},
+                  {"invariant_tsc", lockfree_queues::TscClock::has_invariant_tsc() ? "true" : "false"},
+                  {"runs", std::to_string(settings.runs)},
+                  {"iterations", std::to_string(settings.iterations)},
+                  {"rtt_iterations", std::to_string(settings.rtt_iterations)}});
+  }
+  catch (std::exception const& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
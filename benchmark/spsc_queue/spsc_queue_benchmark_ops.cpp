@@ -0,0 +1,56 @@
+#include "lockfree_queues/spsc_queue.h"
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+struct TestObj
+{
+  size_t x;
+  size_t y;
+};
+
+int main()
+{
+  size_t const queue_size = 65536;
+  size_t const reader_batch_size = 4;
+  int64_t const iterations = 10000000;
+
+  lockfree_queues::SPSCQueue<TestObj> q{queue_size, reader_batch_size};
+
+  size_t total_objects{0};
+
+  std::thread reader_thread{[&q, &total_objects, iterations]
+                            {
+                              size_t n = 0;
+                              while (n < (iterations - 1))
+                              {
+                                TestObj const* item = q.front();
+                                while (!item)
+                                {
+                                  item = q.front();
+                                }
+
+                                total_objects += item->y;
+                                n = item->x;
+
+                                q.pop();
+                              }
+                            }};
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < iterations; ++i)
+  {
+    while (!q.try_emplace(i, 1u))
+      ;
+  }
+
+  reader_thread.join();
+
+  auto stop = std::chrono::steady_clock::now();
+  std::cout << iterations * 1000000 /
+      std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count()
+            << " ops/ms, total_duration: "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count() << " ms";
+}
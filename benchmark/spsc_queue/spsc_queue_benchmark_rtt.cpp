@@ -0,0 +1,50 @@
+#include "lockfree_queues/spsc_queue.h"
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+struct TestObj
+{
+  size_t x;
+  size_t y;
+};
+
+int main()
+{
+  size_t const queue_size = 65536;
+  size_t const reader_batch_size = 4;
+  int64_t const iterations = 10000000;
+
+  lockfree_queues::SPSCQueue<TestObj> q1{queue_size, reader_batch_size};
+  lockfree_queues::SPSCQueue<TestObj> q2{queue_size, reader_batch_size};
+
+  auto t = std::thread(
+    [&q1, &q2, iterations]
+    {
+      for (int i = 0; i < iterations; ++i)
+      {
+        while (!q1.front())
+          ;
+
+        while (!q2.try_emplace(*q1.front()))
+          ;
+        q1.pop();
+      }
+    });
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i)
+  {
+    while (!q1.try_emplace(i, 1u))
+      ;
+
+    while (!q2.front())
+      ;
+    q2.pop();
+  }
+  auto stop = std::chrono::steady_clock::now();
+
+  t.join();
+  std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / iterations << " ns RTT";
+}
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <system_error>
+
+#if defined(__linux__)
+  #include <sys/mman.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+namespace lockfree_queues
+{
+
+enum class HugePageSize : size_t
+{
+  Huge2MB = size_t{2} * 1024u * 1024u,
+  Huge1GB = size_t{1024} * 1024u * 1024u
+};
+
+/***
+ * An allocator that backs the memory with huge pages to reduce TLB misses on large queues. It can
+ * be used as the Allocator template argument of the queues.
+ *
+ * Memory is first requested from the reserved huge page pool with MAP_HUGETLB. When the pool is
+ * empty, a region aligned to the huge page size is mapped and transparent huge pages are requested
+ * for it with madvise instead.
+ *
+ * Optionally the memory can be bound to a NUMA node, prefaulted and locked, so that no page fault
+ * occurs later on the hot path.
+ *
+ * Each allocation is rounded up to the huge page size, so the allocator is meant for a few
+ * large allocations. On platforms other than Linux it falls back to aligned operator new.
+ *
+ * @tparam T Type of the element
+ */
+template <typename T>
+class HugePageAllocator
+{
+public:
+  using value_type = T;
+
+  /** Do not bind the memory to any NUMA node **/
+  static constexpr int NO_NUMA_NODE = -1;
+
+  /** Bind the memory to the NUMA node of the cpu the allocating thread runs on **/
+  static constexpr int CURRENT_NUMA_NODE = -2;
+
+  /**
+   * Constructor
+   * @param page_size Huge page size
+   * @param numa_node NUMA node to bind the memory to, NO_NUMA_NODE or CURRENT_NUMA_NODE
+   * @param prefault Touch all the pages on allocation
+   * @param lock Lock the pages in memory with mlock, it implies prefault
+   */
+  explicit HugePageAllocator(HugePageSize page_size = HugePageSize::Huge2MB,
+                             int numa_node = NO_NUMA_NODE, bool prefault = false, bool lock = false) noexcept
+    : _page_size(page_size), _numa_node(numa_node), _prefault(prefault), _lock(lock)
+  {
+  }
+
+  template <typename U>
+  HugePageAllocator(HugePageAllocator<U> const& other) noexcept
+    : _page_size(other.page_size()), _numa_node(other.numa_node()), _prefault(other.prefault()), _lock(other.lock())
+  {
+  }
+
+  [[nodiscard]] T* allocate(size_t n)
+  {
+    if (n > std::numeric_limits<size_t>::max() / sizeof(T))
+    {
+      throw std::bad_alloc{};
+    }
+
+    size_t const size = _rounded_size(n);
+
+#if defined(__linux__)
+    void* ptr = _map_huge_pages(size);
+
+    if (ptr == MAP_FAILED)
+    {
+      ptr = _map_transparent_huge_pages(size);
+    }
+
+    if (ptr == MAP_FAILED)
+    {
+      throw std::bad_alloc{};
+    }
+
+    try
+    {
+      _bind_numa_node(ptr, size);
+
+      if (_prefault || _lock)
+      {
+        // touch one byte per base page, so that the pages are allocated on the bound node
+        size_t const base_page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        for (size_t offset = 0; offset < size; offset += base_page_size)
+        {
+          static_cast<volatile std::byte*>(ptr)[offset] = std::byte{0};
+        }
+      }
+
+      if (_lock && (::mlock(ptr, size) == -1))
+      {
+        throw std::system_error{errno, std::generic_category(), "mlock failed"};
+      }
+    }
+    catch (...)
+    {
+      ::munmap(ptr, size);
+      throw;
+    }
+
+    return static_cast<T*>(ptr);
+#else
+    return static_cast<T*>(::operator new(size, std::align_val_t{static_cast<size_t>(_page_size)}));
+#endif
+  }
+
+  void deallocate(T* p, size_t n) noexcept
+  {
+#if defined(__linux__)
+    ::munmap(p, _rounded_size(n));
+#else
+    ::operator delete(p, std::align_val_t{static_cast<size_t>(_page_size)});
+#endif
+  }
+
+  [[nodiscard]] HugePageSize page_size() const noexcept { return _page_size; }
+  [[nodiscard]] int numa_node() const noexcept { return _numa_node; }
+  [[nodiscard]] bool prefault() const noexcept { return _prefault; }
+  [[nodiscard]] bool lock() const noexcept { return _lock; }
+
+  template <typename U>
+  [[nodiscard]] bool operator==(HugePageAllocator<U> const& other) const noexcept
+  {
+    return (_page_size == other.page_size()) && (_numa_node == other.numa_node()) &&
+      (_prefault == other.prefault()) && (_lock == other.lock());
+  }
+
+  template <typename U>
+  [[nodiscard]] bool operator!=(HugePageAllocator<U> const& other) const noexcept
+  {
+    return !(*this == other);
+  }
+
+private:
+  [[nodiscard]] size_t _rounded_size(size_t n) const noexcept
+  {
+    size_t const page_size = static_cast<size_t>(_page_size);
+    return ((n * sizeof(T) + page_size - 1) / page_size) * page_size;
+  }
+
+#if defined(__linux__)
+  [[nodiscard]] void* _map_huge_pages(size_t size) const noexcept
+  {
+    // the page size is encoded as log2 in the MAP_HUGE_SHIFT bits
+    int const page_size_log2 = (_page_size == HugePageSize::Huge1GB) ? 30 : 21;
+    int const map_huge_shift = 26;
+
+    return ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (page_size_log2 << map_huge_shift), -1, 0);
+  }
+
+  [[nodiscard]] void* _map_transparent_huge_pages(size_t size) const noexcept
+  {
+    // over allocate to align the region to the huge page size and unmap the excess
+    size_t const alignment = static_cast<size_t>(_page_size);
+    void* ptr = ::mmap(nullptr, size + alignment, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (ptr == MAP_FAILED)
+    {
+      return ptr;
+    }
+
+    uintptr_t const addr = reinterpret_cast<uintptr_t>(ptr);
+    uintptr_t const aligned_addr = (addr + alignment - 1) & ~(alignment - 1);
+
+    if (aligned_addr != addr)
+    {
+      ::munmap(ptr, aligned_addr - addr);
+    }
+
+    if (size_t const tail = (addr + size + alignment) - (aligned_addr + size); tail != 0)
+    {
+      ::munmap(reinterpret_cast<void*>(aligned_addr + size), tail);
+    }
+
+    ::madvise(reinterpret_cast<void*>(aligned_addr), size, MADV_HUGEPAGE);
+
+    return reinterpret_cast<void*>(aligned_addr);
+  }
+
+  void _bind_numa_node(void* ptr, size_t size) const
+  {
+    if (_numa_node == NO_NUMA_NODE)
+    {
+      return;
+    }
+
+    unsigned long node = static_cast<unsigned long>(_numa_node);
+
+    if (_numa_node == CURRENT_NUMA_NODE)
+    {
+      unsigned cpu{0};
+      unsigned current_node{0};
+      if (::syscall(SYS_getcpu, &cpu, &current_node, nullptr) == -1)
+      {
+        throw std::system_error{errno, std::generic_category(), "getcpu failed"};
+      }
+      node = current_node;
+    }
+
+    constexpr unsigned long bits_per_mask = sizeof(unsigned long) * 8u;
+    constexpr int mpol_bind = 2;
+    constexpr unsigned mpol_mf_move = 1u << 1u;
+
+    if (node >= bits_per_mask)
+    {
+      throw std::system_error{EINVAL, std::generic_category(), "NUMA node out of range"};
+    }
+
+    unsigned long const node_mask = 1ul << node;
+
+    // the kernel reads maxnode - 1 bits of the mask, see mbind(2)
+    unsigned long const max_node = (sizeof(node_mask) * 8u) + 1u;
+
+    if (::syscall(SYS_mbind, ptr, size, mpol_bind, &node_mask, max_node, mpol_mf_move) == -1)
+    {
+      throw std::system_error{errno, std::generic_category(), "mbind failed"};
+    }
+  }
+#endif
+
+private:
+  HugePageSize _page_size;
+  int _numa_node;
+  bool _prefault;
+  bool _lock;
+};
+} // namespace lockfree_queues
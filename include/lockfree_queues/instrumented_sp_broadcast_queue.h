@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include "lockfree_queues/latency_histogram.h"
+#include "lockfree_queues/sp_broadcast_queue.h"
+#include "lockfree_queues/wait_strategy.h"
+
+namespace lockfree_queues
+{
+
+/***
+ * A SPBroadcastQueue that measures the latency between the producer publishing an element and
+ * each reader getting it from front().
+ *
+ * The producer stamps each element with the time stamp counter right before publishing it. The
+ * first time front() returns an element to a reader, the elapsed time is recorded in the
+ * LatencyHistogram of that reader, which a monitoring thread can read at any time, e.g. to tell
+ * whether a tail latency spike comes from the queue or from the work of the consumer.
+ *
+ * It offers the basic SPBroadcastQueue API, the stamp costs a time stamp counter read on each side
+ * and 8 bytes per element.
+ *
+ * @tparam T Type of the element
+ * @tparam MAX_READERS Max consumers that can subscribe to this queue
+ * @tparam Allocator An allocator used to allocate memory, it is rebound to the stamped element
+ * @tparam WaitStrategy What the producer and the consumers do while they wait
+ */
+template <typename T, size_t MAX_READERS = 1, typename Allocator = std::allocator<T>, typename WaitStrategy = BusySpinWaitStrategy>
+class InstrumentedSPBroadcastQueue
+{
+public:
+  using value_type = T;
+
+  /**
+   * Constructor
+   * @param capacity Max element capacity
+   * @param reader_batch_size Readers commit their reads to the producer in batches to increase throughput
+   * @param allocator memory allocator
+   */
+  explicit InstrumentedSPBroadcastQueue(size_t capacity, size_t reader_batch_size = 4,
+                                        Allocator const& allocator = Allocator())
+    : _queue(capacity, reader_batch_size, stamped_allocator_type{allocator}),
+      _readers(std::make_unique<ReaderLatency[]>(MAX_READERS))
+  {
+  }
+
+  /** Deleted **/
+  InstrumentedSPBroadcastQueue(InstrumentedSPBroadcastQueue const&) = delete;
+  InstrumentedSPBroadcastQueue& operator=(InstrumentedSPBroadcastQueue const&) = delete;
+
+  template <typename... Args>
+  [[gnu::always_inline, gnu::hot]] void emplace(Args&&... args)
+  {
+    _queue.emplace(_clock, std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  [[gnu::always_inline, gnu::hot, nodiscard]] bool try_emplace(Args&&... args)
+  {
+    return _queue.try_emplace(_clock, std::forward<Args>(args)...);
+  }
+
+  [[gnu::always_inline, gnu::hot, nodiscard]] value_type const* front(size_t reader_id) noexcept
+  {
+    Stamped const* item = _queue.front(reader_id);
+
+    if (!item)
+    {
+      return nullptr;
+    }
+
+    ReaderLatency& reader = _readers[reader_id];
+    size_t const sequence = _queue.sequence(reader_id);
+
+    if (reader.last_sequence != sequence)
+    {
+      // only the first front() of each element is measured
+      uint64_t const now = _clock.now();
+      reader.last_sequence = sequence;
+      reader.histogram.record(_clock.to_ns((now > item->publish_ticks) ? now - item->publish_ticks : 0));
+    }
+
+    return &item->value;
+  }
+
+  [[gnu::always_inline, gnu::hot]] void pop(size_t reader_id) noexcept { _queue.pop(reader_id); }
+
+  [[nodiscard]] size_t subscribe()
+  {
+    size_t const reader_id = _queue.subscribe();
+
+    // the reader starts from the last element already published, if any, which was not published
+    // while the reader was subscribed and is not measured
+    _readers[reader_id].last_sequence =
+      _queue.front(reader_id) ? _queue.sequence(reader_id) : std::numeric_limits<size_t>::max();
+
+    return reader_id;
+  }
+
+  void unsubscribe(size_t reader_id) noexcept { _queue.unsubscribe(reader_id); }
+
+  [[nodiscard]] size_t capacity() const noexcept { return _queue.capacity(); }
+
+  /**
+   * @return the publish to front() latencies of the reader in nanoseconds, it can be read from any
+   * thread. The histogram is kept when the reader unsubscribes
+   */
+  [[nodiscard]] LatencyHistogram const& latency_histogram(size_t reader_id) const noexcept
+  {
+    return _readers[reader_id].histogram;
+  }
+
+private:
+  static constexpr size_t CACHE_LINE_SIZE{128u};
+
+  struct Stamped
+  {
+    /**
+     * Stamps the element once it is constructed, right before the queue publishes it
+     */
+    template <typename... Args>
+    explicit Stamped(TscClock const& clock, Args&&... args) : value{std::forward<Args>(args)...}
+    {
+      publish_ticks = clock.now();
+    }
+
+    uint64_t publish_ticks{0};
+    value_type value;
+  };
+
+  /** Only written by the reader **/
+  struct alignas(CACHE_LINE_SIZE) ReaderLatency
+  {
+    size_t last_sequence{std::numeric_limits<size_t>::max()};
+    LatencyHistogram histogram;
+  };
+
+  using stamped_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<Stamped>;
+
+private:
+  TscClock _clock;
+  SPBroadcastQueue<Stamped, MAX_READERS, stamped_allocator_type, WaitStrategy> _queue;
+  std::unique_ptr<ReaderLatency[]> _readers;
+};
+} // namespace lockfree_queues
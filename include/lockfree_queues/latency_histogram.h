@@ -0,0 +1,263 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include "lockfree_queues/utilities.h"
+
+#if defined(_MSC_VER)
+  #include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+  #include <cpuid.h>
+  #include <x86intrin.h>
+#endif
+
+namespace lockfree_queues
+{
+
+/***
+ * Reads the time stamp counter of the cpu and converts tick differences to nanoseconds.
+ *
+ * The ratio is calibrated against std::chrono::steady_clock on construction. The counter is only
+ * used when it is invariant, i.e. it ticks at a constant rate that is synchronised between the
+ * cores, otherwise steady_clock is read instead. On aarch64 the generic timer counter is used.
+ */
+class TscClock
+{
+public:
+  /**
+   * Constructor
+   * @param calibration_duration How long to measure the tick rate for
+   */
+  explicit TscClock(std::chrono::milliseconds calibration_duration = std::chrono::milliseconds{10})
+    : _use_tsc(has_invariant_tsc())
+  {
+    if (!_use_tsc)
+    {
+      return;
+    }
+
+    auto const start = std::chrono::steady_clock::now();
+    uint64_t const start_ticks = rdtsc();
+
+    while ((std::chrono::steady_clock::now() - start) < calibration_duration)
+    {
+      std::this_thread::yield();
+    }
+
+    uint64_t const stop_ticks = rdtsc();
+    auto const stop = std::chrono::steady_clock::now();
+
+    _ns_per_tick = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count()) /
+      static_cast<double>(stop_ticks - start_ticks);
+  }
+
+  /**
+   * @return the current ticks
+   */
+  [[gnu::always_inline, nodiscard]] uint64_t now() const noexcept
+  {
+    if (_use_tsc)
+    {
+      return rdtsc();
+    }
+
+    return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+  }
+
+  /**
+   * @return the ticks converted to nanoseconds
+   */
+  [[gnu::always_inline, nodiscard]] uint64_t to_ns(uint64_t ticks) const noexcept
+  {
+    return static_cast<uint64_t>(static_cast<double>(ticks) * _ns_per_tick);
+  }
+
+  [[nodiscard]] double ns_per_tick() const noexcept { return _ns_per_tick; }
+
+  /**
+   * @return true if the time stamp counter ticks at a constant rate on all the cores
+   */
+  [[nodiscard]] static bool has_invariant_tsc() noexcept
+  {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int regs[4];
+    __cpuid(regs, 0x80000000);
+    if (static_cast<unsigned>(regs[0]) < 0x80000007u)
+    {
+      return false;
+    }
+
+    __cpuid(regs, 0x80000007);
+    return (regs[3] & (1 << 8)) != 0;
+#elif defined(__x86_64__) || defined(__i386__)
+    unsigned eax, ebx, ecx, edx;
+    if ((__get_cpuid(0x80000000u, &eax, &ebx, &ecx, &edx) == 0) || (eax < 0x80000007u))
+    {
+      return false;
+    }
+
+    __get_cpuid(0x80000007u, &eax, &ebx, &ecx, &edx);
+    return (edx & (1u << 8)) != 0;
+#elif defined(__aarch64__)
+    // the generic timer counter always runs at a fixed frequency
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  /**
+   * @return the raw time stamp counter, or zero where there is none
+   */
+  [[gnu::always_inline, nodiscard]] static uint64_t rdtsc() noexcept
+  {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return 0;
+#endif
+  }
+
+private:
+  double _ns_per_tick{1.0};
+  bool _use_tsc;
+};
+
+/***
+ * A log-linear histogram of latencies, in the style of an HDR histogram. Each power of two range is
+ * split in SUB_BUCKETS linear buckets, so a value is recorded with a relative error below
+ * 1 / SUB_BUCKETS over the whole uint64_t range.
+ *
+ * A single thread records the values, while any thread can read the histogram. The buckets are
+ * atomics updated with a relaxed load and store, so recording never locks a cache line and a
+ * reader sees each bucket either before or after a record.
+ */
+class LatencyHistogram
+{
+public:
+  static constexpr size_t SUB_BUCKET_BITS = 4;
+  static constexpr size_t SUB_BUCKETS = size_t{1} << SUB_BUCKET_BITS;
+
+  /** Values below SUB_BUCKETS have a bucket each, then each power of two has SUB_BUCKETS buckets **/
+  static constexpr size_t BUCKETS = (64u - SUB_BUCKET_BITS + 1u) * SUB_BUCKETS;
+
+  LatencyHistogram() = default;
+
+  /** Deleted **/
+  LatencyHistogram(LatencyHistogram const&) = delete;
+  LatencyHistogram& operator=(LatencyHistogram const&) = delete;
+
+  /**
+   * Records a value, it must only be called by a single thread
+   */
+  [[gnu::always_inline]] void record(uint64_t value) noexcept
+  {
+    std::atomic<uint64_t>& bucket = _buckets[bucket_index(value)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1u, std::memory_order_relaxed);
+
+    if (value > _max.load(std::memory_order_relaxed))
+    {
+      _max.store(value, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @return the number of values recorded
+   */
+  [[nodiscard]] uint64_t count() const noexcept
+  {
+    uint64_t total = 0;
+
+    for (auto const& bucket : _buckets)
+    {
+      total += bucket.load(std::memory_order_relaxed);
+    }
+
+    return total;
+  }
+
+  [[nodiscard]] uint64_t max() const noexcept { return _max.load(std::memory_order_relaxed); }
+
+  /**
+   * @param percentile between 0 and 100, e.g. 99.9
+   * @return the highest value of the bucket the percentile falls in, or zero without any value
+   */
+  [[nodiscard]] uint64_t percentile(double percentile) const noexcept
+  {
+    std::array<uint64_t, BUCKETS> counts;
+    uint64_t total = 0;
+
+    for (size_t i = 0; i < BUCKETS; ++i)
+    {
+      counts[i] = _buckets[i].load(std::memory_order_relaxed);
+      total += counts[i];
+    }
+
+    if (total == 0)
+    {
+      return 0;
+    }
+
+    double const clamped = std::min(std::max(percentile, 0.0), 100.0);
+    uint64_t const rank = std::max(uint64_t{1}, static_cast<uint64_t>((clamped / 100.0) * static_cast<double>(total) + 0.5));
+
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < BUCKETS; ++i)
+    {
+      cumulative += counts[i];
+
+      if (cumulative >= rank)
+      {
+        return std::min(bucket_highest_value(i), max());
+      }
+    }
+
+    return max();
+  }
+
+  /**
+   * @return the bucket a value is recorded in
+   */
+  [[nodiscard]] static size_t bucket_index(uint64_t value) noexcept
+  {
+    if (value < SUB_BUCKETS)
+    {
+      return static_cast<size_t>(value);
+    }
+
+    // the bits below the most significant bit select the linear bucket
+    size_t const shift = (63u - count_leading_zeros(value)) - SUB_BUCKET_BITS;
+    return ((shift + 1u) * SUB_BUCKETS) + static_cast<size_t>((value >> shift) & (SUB_BUCKETS - 1u));
+  }
+
+  /**
+   * @return the highest value recorded in the bucket
+   */
+  [[nodiscard]] static constexpr uint64_t bucket_highest_value(size_t index) noexcept
+  {
+    if (index < SUB_BUCKETS)
+    {
+      return index;
+    }
+
+    size_t const shift = (index / SUB_BUCKETS) - 1u;
+    uint64_t const lowest = (SUB_BUCKETS + (index % SUB_BUCKETS)) << shift;
+    return lowest + ((uint64_t{1} << shift) - 1u);
+  }
+
+private:
+  std::array<std::atomic<uint64_t>, BUCKETS> _buckets{};
+  std::atomic<uint64_t> _max{0};
+};
+} // namespace lockfree_queues
@@ -0,0 +1,353 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+#include "lockfree_queues/utilities.h"
+
+namespace lockfree_queues
+{
+
+/***
+ * A bounded multiple-producer multiple-consumer queue, where each element is consumed by exactly
+ * one consumer.
+ *
+ * Each slot carries a sequence number telling whether it is free for the producer of a given
+ * round or holds an element ready for the consumer of that round (Vyukov's bounded MPMC queue).
+ * Producers and consumers claim slots by advancing the write and read indexes respectively, either
+ * with a single fetch_add in the blocking emplace() and pop(), or with a compare and swap in
+ * the try_ variants so that they can fail when the queue is full or empty.
+ *
+ * The batch variants claim multiple contiguous slots with a single compare and swap.
+ *
+ * @tparam T Type of the element
+ * @tparam Allocator An allocator used to allocate memory
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+class MPMCQueue
+{
+private:
+  struct Slot
+  {
+    std::atomic<size_t> sequence;
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+
+  using slot_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<Slot>;
+
+public:
+  using value_type = T;
+
+  /**
+   * Constructor
+   * @param capacity Max element capacity
+   * @param allocator memory allocator
+   */
+  explicit MPMCQueue(size_t capacity, Allocator const& allocator = Allocator())
+    : _capacity(std::max(size_t{16}, next_power_of_two(capacity))),
+      _capacity_minus_one(_capacity - 1),
+      _allocator(allocator)
+  {
+    // we add some padding to the start and end of the buffer to protect it from false sharing
+    // --- padding --- | --- slots* ---- | --- padding --- |
+    _buffer = std::allocator_traits<slot_allocator_type>::allocate(_allocator, _capacity + (2u * PADDING));
+    _slots = _buffer + PADDING;
+
+    for (size_t i = 0; i < _capacity; ++i)
+    {
+      ::new (static_cast<void*>(&_slots[i].sequence)) std::atomic<size_t>{i};
+    }
+  }
+
+  /**
+   * Destructor, the queue must not be used concurrently
+   */
+  ~MPMCQueue()
+  {
+    size_t const write_idx = _write_idx.load(std::memory_order_relaxed);
+
+    for (size_t i = _read_idx.load(std::memory_order_relaxed); i != write_idx; ++i)
+    {
+      _value(_slots[i & _capacity_minus_one])->~T();
+    }
+
+    std::allocator_traits<slot_allocator_type>::deallocate(_allocator, _buffer, _capacity + (2u * PADDING));
+  }
+
+  /** Deleted **/
+  MPMCQueue(MPMCQueue const&) = delete;
+  MPMCQueue& operator=(MPMCQueue const&) = delete;
+
+  /**
+   * Claims a slot with a single fetch_add and waits until it is free
+   */
+  template <typename... Args>
+  [[gnu::always_inline, gnu::hot]] void emplace(Args&&... args)
+  {
+    size_t const write_idx = _write_idx.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = _slots[write_idx & _capacity_minus_one];
+
+    while (slot.sequence.load(std::memory_order_acquire) != write_idx)
+    {
+      // wait for a consumer to free the slot
+    }
+
+    ::new (static_cast<void*>(slot.storage)) value_type{std::forward<Args>(args)...};
+    slot.sequence.store(write_idx + 1, std::memory_order_release);
+  }
+
+  template <typename... Args>
+  [[gnu::always_inline, gnu::hot, nodiscard]] bool try_emplace(Args&&... args)
+  {
+    size_t write_idx;
+
+    if (!_try_claim_write(1, write_idx))
+    {
+      return false;
+    }
+
+    Slot& slot = _slots[write_idx & _capacity_minus_one];
+    ::new (static_cast<void*>(slot.storage)) value_type{std::forward<Args>(args)...};
+    slot.sequence.store(write_idx + 1, std::memory_order_release);
+
+    return true;
+  }
+
+  /**
+   * Claims contiguous slots for all the elements of the range [first, last) at once and then
+   * constructs and publishes them. Either all the elements are written or none.
+   * @return false if there is not enough space for the whole range
+   */
+  template <typename ForwardIt>
+  [[gnu::hot, nodiscard]] bool try_emplace_n(ForwardIt first, ForwardIt last)
+  {
+    size_t const n = static_cast<size_t>(std::distance(first, last));
+    size_t write_idx;
+
+    if ((n == 0) || !_try_claim_write(n, write_idx))
+    {
+      return n == 0;
+    }
+
+    for (size_t i = 0; i < n; ++i, ++first)
+    {
+      Slot& slot = _slots[(write_idx + i) & _capacity_minus_one];
+      ::new (static_cast<void*>(slot.storage)) value_type{*first};
+      slot.sequence.store(write_idx + i + 1, std::memory_order_release);
+    }
+
+    return true;
+  }
+
+  /**
+   * Claims an element with a single fetch_add and waits until it is published
+   */
+  [[gnu::always_inline, gnu::hot]] void pop(value_type& out) noexcept
+  {
+    size_t const read_idx = _read_idx.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = _slots[read_idx & _capacity_minus_one];
+
+    while (slot.sequence.load(std::memory_order_acquire) != read_idx + 1)
+    {
+      // wait for a producer to publish the slot
+    }
+
+    _consume(slot, read_idx, out);
+  }
+
+  /**
+   * Moves the next element to out
+   * @return false if the queue is empty
+   */
+  [[gnu::always_inline, gnu::hot, nodiscard]] bool try_pop(value_type& out) noexcept
+  {
+    size_t read_idx = _read_idx.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+      Slot& slot = _slots[read_idx & _capacity_minus_one];
+      size_t const sequence = slot.sequence.load(std::memory_order_acquire);
+      auto const diff = static_cast<std::make_signed_t<size_t>>(sequence - (read_idx + 1));
+
+      if (diff == 0)
+      {
+        if (_read_idx.compare_exchange_weak(read_idx, read_idx + 1, std::memory_order_relaxed))
+        {
+          _consume(slot, read_idx, out);
+          return true;
+        }
+      }
+      else if (diff < 0)
+      {
+        // the slot has not been published yet
+        return false;
+      }
+      else
+      {
+        // another consumer claimed the slot
+        read_idx = _read_idx.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * Claims up to max_n contiguous published elements at once and moves them to out
+   * @return the number of elements moved
+   */
+  template <typename OutputIt>
+  [[gnu::hot, nodiscard]] size_t try_pop_n(OutputIt out, size_t max_n) noexcept
+  {
+    if (max_n == 0)
+    {
+      return 0;
+    }
+
+    size_t read_idx = _read_idx.load(std::memory_order_relaxed);
+    size_t n;
+
+    while (true)
+    {
+      size_t const sequence = _slots[read_idx & _capacity_minus_one].sequence.load(std::memory_order_acquire);
+      auto const diff = static_cast<std::make_signed_t<size_t>>(sequence - (read_idx + 1));
+
+      if (diff < 0)
+      {
+        // the slot has not been published yet
+        return 0;
+      }
+
+      if (diff > 0)
+      {
+        // another consumer claimed the slot
+        read_idx = _read_idx.load(std::memory_order_relaxed);
+        continue;
+      }
+
+      // count the published elements following the first one
+      for (n = 1; (n < max_n) &&
+           (_slots[(read_idx + n) & _capacity_minus_one].sequence.load(std::memory_order_acquire) ==
+            read_idx + n + 1);
+           ++n)
+      {
+      }
+
+      if (_read_idx.compare_exchange_weak(read_idx, read_idx + n, std::memory_order_relaxed))
+      {
+        break;
+      }
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+      Slot& slot = _slots[(read_idx + i) & _capacity_minus_one];
+      *out = std::move(*_value(slot));
+      ++out;
+      _release(slot, read_idx + i);
+    }
+
+    return n;
+  }
+
+  [[nodiscard]] size_t capacity() const noexcept { return _capacity; }
+
+private:
+  static_assert(std::is_nothrow_destructible<value_type>::value, "T must be nothrow destructible");
+  static_assert(std::is_nothrow_move_assignable<value_type>::value, "T must be nothrow move assignable");
+
+  static constexpr size_t CACHE_LINE_SIZE{128u};
+
+  static constexpr size_t PADDING =
+    (CACHE_LINE_SIZE - 1) / sizeof(Slot) + 1; /** How many Slots can we fit in a cache line **/
+
+  [[gnu::always_inline, nodiscard]] static value_type* _value(Slot& slot) noexcept
+  {
+    return std::launder(reinterpret_cast<value_type*>(slot.storage));
+  }
+
+  [[gnu::always_inline]] void _consume(Slot& slot, size_t read_idx, value_type& out) noexcept
+  {
+    out = std::move(*_value(slot));
+    _release(slot, read_idx);
+  }
+
+  /**
+   * Destroys the element and hands the slot to the producers of the next round
+   */
+  [[gnu::always_inline]] void _release(Slot& slot, size_t read_idx) noexcept
+  {
+    _value(slot)->~value_type();
+    slot.sequence.store(read_idx + _capacity, std::memory_order_release);
+  }
+
+  /**
+   * Claims n contiguous slots if they are all free
+   */
+  [[gnu::always_inline, nodiscard]] bool _try_claim_write(size_t n, size_t& write_idx) noexcept
+  {
+    if (n > _capacity)
+    {
+      return false;
+    }
+
+    write_idx = _write_idx.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+      // Slots are freed in order of their claim. A consumer may still be moving out of an earlier
+      // slot, so all of them are checked
+      size_t i = 0;
+      std::make_signed_t<size_t> diff = 0;
+
+      for (; i < n; ++i)
+      {
+        size_t const sequence =
+          _slots[(write_idx + i) & _capacity_minus_one].sequence.load(std::memory_order_acquire);
+        diff = static_cast<std::make_signed_t<size_t>>(sequence - (write_idx + i));
+
+        if (diff != 0)
+        {
+          break;
+        }
+      }
+
+      if (i == n)
+      {
+        if (_write_idx.compare_exchange_weak(write_idx, write_idx + n, std::memory_order_relaxed))
+        {
+          return true;
+        }
+      }
+      else if (diff < 0)
+      {
+        // the slot still holds an element of the previous round
+        return false;
+      }
+      else
+      {
+        // another producer claimed the slot
+        write_idx = _write_idx.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+private:
+  /** Members **/
+  size_t _capacity;
+  size_t _capacity_minus_one;
+  Slot* _slots = nullptr;
+  Slot* _buffer = nullptr;
+  slot_allocator_type _allocator;
+
+  /** Shared by the producers **/
+  alignas(CACHE_LINE_SIZE) std::atomic<size_t> _write_idx = {0};
+
+  /** Shared by the consumers **/
+  alignas(CACHE_LINE_SIZE) std::atomic<size_t> _read_idx = {0};
+};
+} // namespace lockfree_queues
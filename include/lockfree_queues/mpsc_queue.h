@@ -0,0 +1,240 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+#include "lockfree_queues/utilities.h"
+
+namespace lockfree_queues
+{
+
+/***
+ * A bounded multiple-producer single-consumer queue.
+ *
+ * Each slot carries a sequence number telling whether it is free for the producer of a given
+ * round or holds an element ready for the consumer. Producers claim slots by advancing a shared
+ * write index, either with a single fetch_add in emplace(), or with a compare and swap in
+ * try_emplace() so that it can fail when the queue is full. The producers then publish each slot
+ * independently through its sequence number, so a slow producer only delays the consumer at its
+ * own slot.
+ *
+ * The consumer owns its read index and never touches the write index. It destroys the elements
+ * when consuming them and hands the slot back to the producers of the next round.
+ *
+ * @tparam T Type of the element
+ * @tparam Allocator An allocator used to allocate memory
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+class MPSCQueue
+{
+private:
+  struct Slot
+  {
+    std::atomic<size_t> sequence;
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+
+  using slot_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<Slot>;
+
+public:
+  using value_type = T;
+
+  /**
+   * Constructor
+   * @param capacity Max element capacity
+   * @param allocator memory allocator
+   */
+  explicit MPSCQueue(size_t capacity, Allocator const& allocator = Allocator())
+    : _capacity(std::max(size_t{16}, next_power_of_two(capacity))),
+      _capacity_minus_one(_capacity - 1),
+      _allocator(allocator)
+  {
+    // we add some padding to the start and end of the buffer to protect it from false sharing
+    // --- padding --- | --- slots* ---- | --- padding --- |
+    _buffer = std::allocator_traits<slot_allocator_type>::allocate(_allocator, _capacity + (2u * PADDING));
+    _slots = _buffer + PADDING;
+
+    for (size_t i = 0; i < _capacity; ++i)
+    {
+      ::new (static_cast<void*>(&_slots[i].sequence)) std::atomic<size_t>{i};
+    }
+  }
+
+  /**
+   * Destructor, the queue must not be used concurrently
+   */
+  ~MPSCQueue()
+  {
+    size_t const write_idx = _write_idx.load(std::memory_order_relaxed);
+
+    for (size_t i = _read_idx; i != write_idx; ++i)
+    {
+      _value(_slots[i & _capacity_minus_one])->~T();
+    }
+
+    std::allocator_traits<slot_allocator_type>::deallocate(_allocator, _buffer, _capacity + (2u * PADDING));
+  }
+
+  /** Deleted **/
+  MPSCQueue(MPSCQueue const&) = delete;
+  MPSCQueue& operator=(MPSCQueue const&) = delete;
+
+  /**
+   * Claims a slot with a single fetch_add and waits until it is free
+   */
+  template <typename... Args>
+  [[gnu::always_inline, gnu::hot]] void emplace(Args&&... args)
+  {
+    size_t const write_idx = _write_idx.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = _slots[write_idx & _capacity_minus_one];
+
+    while (slot.sequence.load(std::memory_order_acquire) != write_idx)
+    {
+      // wait for the consumer to free the slot
+    }
+
+    ::new (static_cast<void*>(slot.storage)) value_type{std::forward<Args>(args)...};
+    slot.sequence.store(write_idx + 1, std::memory_order_release);
+  }
+
+  template <typename... Args>
+  [[gnu::always_inline, gnu::hot, nodiscard]] bool try_emplace(Args&&... args)
+  {
+    size_t write_idx;
+
+    if (!_try_claim(1, write_idx))
+    {
+      return false;
+    }
+
+    Slot& slot = _slots[write_idx & _capacity_minus_one];
+    ::new (static_cast<void*>(slot.storage)) value_type{std::forward<Args>(args)...};
+    slot.sequence.store(write_idx + 1, std::memory_order_release);
+
+    return true;
+  }
+
+  /**
+   * Claims contiguous slots for all the elements of the range [first, last) at once and then
+   * constructs and publishes them. Either all the elements are written or none.
+   * @return false if there is not enough space for the whole range
+   */
+  template <typename ForwardIt>
+  [[gnu::hot, nodiscard]] bool try_emplace_n(ForwardIt first, ForwardIt last)
+  {
+    size_t const n = static_cast<size_t>(std::distance(first, last));
+    size_t write_idx;
+
+    if ((n == 0) || !_try_claim(n, write_idx))
+    {
+      return n == 0;
+    }
+
+    for (size_t i = 0; i < n; ++i, ++first)
+    {
+      Slot& slot = _slots[(write_idx + i) & _capacity_minus_one];
+      ::new (static_cast<void*>(slot.storage)) value_type{*first};
+      slot.sequence.store(write_idx + i + 1, std::memory_order_release);
+    }
+
+    return true;
+  }
+
+  [[gnu::always_inline, gnu::hot, nodiscard]] value_type* front() noexcept
+  {
+    Slot& slot = _slots[_read_idx & _capacity_minus_one];
+
+    if (slot.sequence.load(std::memory_order_acquire) != _read_idx + 1)
+    {
+      return nullptr;
+    }
+
+    return _value(slot);
+  }
+
+  /**
+   * Destroys the element returned by front() and hands the slot back to the producers
+   */
+  [[gnu::always_inline, gnu::hot]] void pop() noexcept
+  {
+    Slot& slot = _slots[_read_idx & _capacity_minus_one];
+    _value(slot)->~value_type();
+    slot.sequence.store(_read_idx + _capacity, std::memory_order_release);
+    _read_idx += 1;
+  }
+
+  [[nodiscard]] size_t capacity() const noexcept { return _capacity; }
+
+private:
+  static_assert(std::is_nothrow_destructible<value_type>::value, "T must be nothrow destructible");
+
+  static constexpr size_t CACHE_LINE_SIZE{128u};
+
+  static constexpr size_t PADDING =
+    (CACHE_LINE_SIZE - 1) / sizeof(Slot) + 1; /** How many Slots can we fit in a cache line **/
+
+  [[gnu::always_inline, nodiscard]] static value_type* _value(Slot& slot) noexcept
+  {
+    return std::launder(reinterpret_cast<value_type*>(slot.storage));
+  }
+
+  /**
+   * Claims n contiguous slots if they are all free
+   */
+  [[gnu::always_inline, nodiscard]] bool _try_claim(size_t n, size_t& write_idx) noexcept
+  {
+    if (n > _capacity)
+    {
+      return false;
+    }
+
+    write_idx = _write_idx.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+      // The consumer frees slots in order, when the last slot is free all the previous are too
+      size_t const last_idx = write_idx + n - 1;
+      size_t const sequence = _slots[last_idx & _capacity_minus_one].sequence.load(std::memory_order_acquire);
+      auto const diff = static_cast<std::make_signed_t<size_t>>(sequence - last_idx);
+
+      if (diff == 0)
+      {
+        if (_write_idx.compare_exchange_weak(write_idx, write_idx + n, std::memory_order_relaxed))
+        {
+          return true;
+        }
+      }
+      else if (diff < 0)
+      {
+        // the slot still holds an element of the previous round
+        return false;
+      }
+      else
+      {
+        // another producer claimed the slot
+        write_idx = _write_idx.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+private:
+  /** Members **/
+  size_t _capacity;
+  size_t _capacity_minus_one;
+  Slot* _slots = nullptr;
+  Slot* _buffer = nullptr;
+  slot_allocator_type _allocator;
+
+  /** Shared by the producers **/
+  alignas(CACHE_LINE_SIZE) std::atomic<size_t> _write_idx = {0};
+
+  /** Consumer local **/
+  alignas(CACHE_LINE_SIZE) size_t _read_idx{0};
+};
+} // namespace lockfree_queues
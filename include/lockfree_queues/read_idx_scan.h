@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <limits>
+
+namespace lockfree_queues
+{
+
+/***
+ * The handshake between the producer reloading the min read index of the readers and a reader
+ * joining, shared by SPBroadcastQueue and ShmSPBroadcastQueue.
+ *
+ * The producer only reloads the read indexes when its cached min read index says the queue is
+ * full, so until then it can overwrite the elements below that cached min. Each reload is
+ * published here, and a reader joining below the last published min is moved up to it.
+ *
+ * It only holds atomics, so it can live in shared memory.
+ */
+class ReadIdxScan
+{
+public:
+  /** Read indexes from this value up mark a free or an evicted reader, not a position **/
+  static constexpr size_t NO_READ_IDX = std::numeric_limits<size_t>::max() - 1;
+
+  /**
+   * Reloads the min read index. Called by the producer
+   * @param load_min_read_idx loads the read indexes of the readers with relaxed loads and returns
+   * their min
+   */
+  template <typename LoadMinReadIdx>
+  [[nodiscard]] size_t scan(LoadMinReadIdx const& load_min_read_idx) noexcept
+  {
+    // an odd sequence marks a scan in progress, the fence orders it before the loads of the read
+    // indexes
+    size_t const scan_seq = _scan_seq.load(std::memory_order_relaxed);
+    _scan_seq.store(scan_seq + 1u, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    size_t const min_read_idx = load_min_read_idx();
+
+    // order the reads of the readers before the producer overwrites their slots
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    _scanned_min_read_idx.store(min_read_idx, std::memory_order_relaxed);
+    _scan_seq.store(scan_seq + 2u, std::memory_order_release);
+    return min_read_idx;
+  }
+
+  /**
+   * Publishes the read index of a joining reader
+   * @param read_idx_slot the read index of the reader the producer scans
+   * @param read_idx where the reader wants to start
+   * @param write_idx the write index of the producer
+   * @return the read index the reader starts from
+   */
+  [[nodiscard]] size_t join(std::atomic<size_t>& read_idx_slot, size_t read_idx,
+                            std::atomic<size_t> const& write_idx) const noexcept
+  {
+    read_idx_slot.store(read_idx, std::memory_order_relaxed);
+
+    // Pairs with the fence of scan(). Either the next scan of the producer sees the read index, or
+    // this thread sees that scan started
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    size_t const scan_seq = _scan_seq.load(std::memory_order_acquire);
+
+    // the result of a scan in progress is not known, but it is not above the write index
+    size_t const min_read_idx = (scan_seq & 1u) ? write_idx.load(std::memory_order_relaxed)
+                                                : _scanned_min_read_idx.load(std::memory_order_relaxed);
+
+    if ((min_read_idx < NO_READ_IDX) && (min_read_idx > read_idx))
+    {
+      // the compare and swap fails if the reader was evicted or freed in the meantime
+      size_t expected = read_idx;
+      read_idx_slot.compare_exchange_strong(expected, min_read_idx, std::memory_order_release,
+                                            std::memory_order_relaxed);
+      read_idx = min_read_idx;
+    }
+
+    return read_idx;
+  }
+
+private:
+  std::atomic<size_t> _scan_seq{0};
+  std::atomic<size_t> _scanned_min_read_idx{std::numeric_limits<size_t>::max()};
+};
+} // namespace lockfree_queues
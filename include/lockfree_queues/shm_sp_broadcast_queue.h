@@ -0,0 +1,511 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "lockfree_queues/read_idx_scan.h"
+#include "lockfree_queues/utilities.h"
+#include "lockfree_queues/wait_strategy.h"
+
+namespace lockfree_queues
+{
+
+/***
+ * A bounded single-producer multiple-consumer broadcast queue living in POSIX shared memory, so
+ * that the producer and the consumers can run in different processes.
+ *
+ * It follows the same protocol as SPBroadcastQueue. The indexes, the reader slots and the ring
+ * buffer are all stored in a single named shared memory region. The producer process creates the
+ * region, and the consumer processes attach to it by name and then "subscribe()" to it.
+ *
+ * Everything stored in the region is position independent, so only trivially copyable types can
+ * be used, and the same type and MAX_READERS must be used by all the processes.
+ *
+ * The region is removed when the producer's queue is destroyed. Processes that are already
+ * attached keep their mapping.
+ *
+ * Subscribing is lock-free, a reader slot is claimed with a compare and swap that records the pid
+ * of the owning process next to the read index. A consumer process that dies while subscribed
+ * holds back the producer until its slot is freed, either with reclaim_dead_readers(), which frees
+ * the slots of the processes that no longer exist, or with force_unsubscribe().
+ *
+ * @tparam T Type of the element
+ * @tparam MAX_READERS Max consumers that can subscribe to this queue across all the processes
+ * @tparam WaitStrategy What the producer does while the queue is full. It is local to each
+ * process and can not wake up the readers of another process, so the readers poll front()
+ */
+template <typename T, size_t MAX_READERS = 1, typename WaitStrategy = BusySpinWaitStrategy>
+class ShmSPBroadcastQueue
+{
+public:
+  using value_type = T;
+
+  /**
+   * Creates a new shared memory region and the queue in it. Used by the producer
+   * @param name Name of the shared memory region e.g. "/market_data"
+   * @param capacity Max element capacity
+   * @param reader_batch_size Readers commit their reads to the producer in batches to increase throughput
+   */
+  ShmSPBroadcastQueue(std::string name, size_t capacity, size_t reader_batch_size = 4)
+    : _name(std::move(name)), _is_owner(true)
+  {
+    size_t const queue_capacity = std::max(size_t{16}, next_power_of_two(capacity));
+    size_t const items_per_batch = queue_capacity / reader_batch_size;
+
+    if (!is_power_of_two(items_per_batch))
+    {
+      throw std::runtime_error{"items per batch must be power of 2"};
+    }
+
+    int const fd = ::shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+
+    if (fd == -1)
+    {
+      throw std::runtime_error{"shm_open failed, error: " + std::string{std::strerror(errno)}};
+    }
+
+    _region_size = region_size(queue_capacity);
+
+    if (::ftruncate(fd, static_cast<off_t>(_region_size)) == -1)
+    {
+      int const error = errno;
+      ::close(fd);
+      ::shm_unlink(_name.c_str());
+      throw std::runtime_error{"ftruncate failed, error: " + std::string{std::strerror(error)}};
+    }
+
+    _map(fd);
+
+    _header = ::new (_region) Header{};
+    _header->capacity = queue_capacity;
+    _header->items_per_batch_minus_one = items_per_batch - 1;
+    _header->max_readers = MAX_READERS;
+    _header->value_size = sizeof(value_type);
+
+    for (size_t i = 0; i < MAX_READERS; ++i)
+    {
+      _header->read_idx[i].store(std::numeric_limits<size_t>::max());
+    }
+
+    for (size_t i = 0; i < MAX_READERS; ++i)
+    {
+      _header->owner_pid[i].store(FREE_READER);
+    }
+
+    _header->write_idx.store(0);
+
+    _init_local();
+
+    // publish the header to the processes attaching
+    _header->magic.store(MAGIC, std::memory_order_release);
+  }
+
+  /**
+   * Attaches to a queue created by another process. Used by the consumers
+   * @param name Name of the shared memory region
+   */
+  explicit ShmSPBroadcastQueue(std::string name) : _name(std::move(name)), _is_owner(false)
+  {
+    int const fd = ::shm_open(_name.c_str(), O_RDWR, 0);
+
+    if (fd == -1)
+    {
+      throw std::runtime_error{"shm_open failed, error: " + std::string{std::strerror(errno)}};
+    }
+
+    struct stat st;
+    if ((::fstat(fd, &st) == -1) || (static_cast<size_t>(st.st_size) < sizeof(Header)))
+    {
+      ::close(fd);
+      throw std::runtime_error{"shared memory queue is not initialised"};
+    }
+
+    _region_size = static_cast<size_t>(st.st_size);
+    _map(fd);
+    _header = reinterpret_cast<Header*>(_region);
+
+    if (_header->magic.load(std::memory_order_acquire) != MAGIC)
+    {
+      ::munmap(_region, _region_size);
+      throw std::runtime_error{"shared memory queue is not initialised"};
+    }
+
+    if ((_header->max_readers != MAX_READERS) || (_header->value_size != sizeof(value_type)) ||
+        (region_size(_header->capacity) != _region_size))
+    {
+      ::munmap(_region, _region_size);
+      throw std::runtime_error{"shared memory queue layout does not match"};
+    }
+
+    _init_local();
+  }
+
+  /**
+   * The producer unlinks the region
+   */
+  ~ShmSPBroadcastQueue()
+  {
+    ::munmap(_region, _region_size);
+
+    if (_is_owner)
+    {
+      ::shm_unlink(_name.c_str());
+    }
+  }
+
+  /** Deleted **/
+  ShmSPBroadcastQueue(ShmSPBroadcastQueue const&) = delete;
+  ShmSPBroadcastQueue& operator=(ShmSPBroadcastQueue const&) = delete;
+
+  template <typename... Args>
+  [[gnu::always_inline, gnu::hot]] void emplace(Args&&... args)
+  {
+    for (uint32_t attempt = 0; !try_emplace(std::forward<Args>(args)...); ++attempt)
+    {
+      _wait_strategy.wait(attempt);
+    }
+  }
+
+  template <typename... Args>
+  [[gnu::always_inline, gnu::hot, nodiscard]] bool try_emplace(Args&&... args)
+  {
+    value_type* slot = try_reserve();
+
+    if (!slot)
+    {
+      return false;
+    }
+
+    ::new (static_cast<void*>(slot)) value_type{std::forward<Args>(args)...};
+    commit();
+
+    return true;
+  }
+
+  /**
+   * Reserves the next slot for writing without publishing it. The element must be written in the
+   * returned storage and then published with commit()
+   * @return pointer to the storage of the next slot or nullptr when the queue is full
+   */
+  [[gnu::always_inline, gnu::hot, nodiscard]] value_type* try_reserve() noexcept
+  {
+    size_t const write_idx = _header->write_idx.load(std::memory_order_relaxed);
+
+    if ((_min_read_idx_cache == std::numeric_limits<size_t>::max()) ||
+        ((write_idx - _min_read_idx_cache) == _capacity))
+    {
+      _min_read_idx_cache = _load_min_read_idx();
+
+      if ((_min_read_idx_cache == std::numeric_limits<size_t>::max()) ||
+          ((write_idx - _min_read_idx_cache) == _capacity))
+      {
+        return nullptr;
+      }
+    }
+
+    return &_slots[write_idx & _capacity_minus_one];
+  }
+
+  /**
+   * Publishes the element previously written to the slot returned by try_reserve()
+   */
+  [[gnu::always_inline, gnu::hot]] void commit() noexcept
+  {
+    _header->write_idx.store(_header->write_idx.load(std::memory_order_relaxed) + 1,
+                             std::memory_order_release);
+  }
+
+  [[gnu::always_inline, gnu::hot, nodiscard]] value_type const* front(size_t reader_id) noexcept
+  {
+    if (_reader_cache[reader_id].read_local_idx == _reader_cache[reader_id].write_idx_cache)
+    {
+      _reader_cache[reader_id].write_idx_cache = _header->write_idx.load(std::memory_order_acquire);
+      if (_reader_cache[reader_id].read_local_idx == _reader_cache[reader_id].write_idx_cache)
+      {
+        return nullptr;
+      }
+    }
+
+    return &_slots[_reader_cache[reader_id].read_local_idx & _capacity_minus_one];
+  }
+
+  [[gnu::always_inline, gnu::hot]] void pop(size_t reader_id) noexcept
+  {
+    _reader_cache[reader_id].read_local_idx += 1;
+
+    if ((_reader_cache[reader_id].read_local_idx & _items_per_batch_minus_one) == 0)
+    {
+      _header->read_idx[reader_id].store(_reader_cache[reader_id].read_local_idx, std::memory_order_release);
+    }
+  }
+
+  [[nodiscard]] size_t capacity() const noexcept { return _capacity; }
+
+  /**
+   * Subscribes a reader. Subscribing is lock-free and can happen while the producer and the readers
+   * of the other processes are running.
+   * @return the reader id
+   */
+  [[nodiscard]] size_t subscribe()
+  {
+    pid_t const pid = ::getpid();
+    size_t index = 0;
+
+    for (; index < MAX_READERS; ++index)
+    {
+      pid_t expected = FREE_READER;
+      if (_header->owner_pid[index].compare_exchange_strong(expected, pid, std::memory_order_acquire,
+                                                            std::memory_order_relaxed))
+      {
+        break;
+      }
+    }
+
+    if (index == MAX_READERS)
+    {
+      throw std::runtime_error{"Max consumers reached"};
+    }
+
+    size_t const write_idx = _header->write_idx.load(std::memory_order_acquire);
+    size_t const last_write_idx = (write_idx == 0) ? 0 : write_idx - 1;
+
+    _reader_cache[index].set(_join(index, last_write_idx));
+    return index;
+  }
+
+  /**
+   * Unsubscribes a reader of this process. When another process already freed the slot with
+   * force_unsubscribe() or reclaim_dead_readers(), the slot is left alone as it may have been
+   * claimed again in the meantime.
+   */
+  void unsubscribe(size_t reader_id) noexcept
+  {
+    _reader_cache[reader_id].reset();
+
+    pid_t pid = ::getpid();
+    if (_header->owner_pid[reader_id].compare_exchange_strong(pid, RECLAIMING_READER, std::memory_order_relaxed))
+    {
+      _release_reader(reader_id);
+    }
+  }
+
+  /**
+   * Frees the slot of a reader of any process, e.g. of a consumer process that is known to be hung.
+   * The reader must not be used anymore by its process, the producer can overwrite the elements it
+   * is reading from then on.
+   */
+  void force_unsubscribe(size_t reader_id) noexcept
+  {
+    pid_t pid = _header->owner_pid[reader_id].load(std::memory_order_relaxed);
+
+    // only one process frees a slot, and a slot claimed again in the meantime is left alone
+    if ((pid != FREE_READER) && (pid != RECLAIMING_READER) &&
+        _header->owner_pid[reader_id].compare_exchange_strong(pid, RECLAIMING_READER, std::memory_order_relaxed))
+    {
+      _release_reader(reader_id);
+    }
+  }
+
+  /**
+   * Frees the slots of the readers whose process does not exist anymore. It can be called by any
+   * process, e.g. by the producer when the queue stays full. The pids are checked with kill(pid, 0),
+   * so all the processes must share the same pid namespace, and a process that exited is only seen
+   * as dead once its parent reaped it.
+   * @return the number of slots freed
+   */
+  size_t reclaim_dead_readers() noexcept
+  {
+    size_t reclaimed = 0;
+
+    for (size_t reader_id = 0; reader_id < MAX_READERS; ++reader_id)
+    {
+      pid_t pid = _header->owner_pid[reader_id].load(std::memory_order_relaxed);
+
+      if ((pid == FREE_READER) || (pid == RECLAIMING_READER) || (::kill(pid, 0) == 0) || (errno != ESRCH))
+      {
+        continue;
+      }
+
+      if (_header->owner_pid[reader_id].compare_exchange_strong(pid, RECLAIMING_READER, std::memory_order_relaxed))
+      {
+        _release_reader(reader_id);
+        ++reclaimed;
+      }
+    }
+
+    return reclaimed;
+  }
+
+  /**
+   * @return the pid of the process that subscribed the reader, or zero if it is not subscribed
+   */
+  [[nodiscard]] pid_t owner_pid(size_t reader_id) const noexcept
+  {
+    pid_t const pid = _header->owner_pid[reader_id].load(std::memory_order_relaxed);
+    return (pid == RECLAIMING_READER) ? FREE_READER : pid;
+  }
+
+private:
+  static_assert(std::is_trivially_copyable_v<value_type>, "T must be trivially copyable");
+  static_assert(std::atomic<size_t>::is_always_lock_free, "atomics must be address free");
+  static_assert(std::atomic<pid_t>::is_always_lock_free, "atomics must be address free");
+  static_assert(MAX_READERS != 0, "MAX_READERS can not be zero");
+
+  static constexpr size_t CACHE_LINE_SIZE{128u};
+  static constexpr uint64_t MAGIC{0x4C46515348513033}; /** "LFQSHQ03" **/
+
+  /** Owner pid of a reader slot that is free, and of a slot being freed by another process **/
+  static constexpr pid_t FREE_READER{0};
+  static constexpr pid_t RECLAIMING_READER{-1};
+
+  struct ReaderCache
+  {
+    void set(size_t v) noexcept
+    {
+      read_local_idx = v;
+      write_idx_cache = v;
+    }
+
+    void reset() noexcept { set(std::numeric_limits<size_t>::max()); }
+
+    alignas(CACHE_LINE_SIZE) size_t read_local_idx{std::numeric_limits<size_t>::max()};
+    size_t write_idx_cache{std::numeric_limits<size_t>::max()};
+  };
+
+  /**
+   * Stored at the start of the shared memory region, followed by the slots
+   */
+  struct Header
+  {
+    std::atomic<uint64_t> magic{0};
+    size_t capacity{0};
+    size_t items_per_batch_minus_one{0};
+    size_t max_readers{0};
+    size_t value_size{0};
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> write_idx{0};
+
+    /** The last scan of the read indexes by the producer, see ReadIdxScan **/
+    alignas(CACHE_LINE_SIZE) ReadIdxScan read_idx_scan;
+
+    alignas(CACHE_LINE_SIZE) std::array<std::atomic<size_t>, MAX_READERS> read_idx;
+
+    /** Only touched when subscribing and unsubscribing **/
+    alignas(CACHE_LINE_SIZE) std::array<std::atomic<pid_t>, MAX_READERS> owner_pid;
+  };
+
+  /** The slots start on a cache line after the header, and are followed by a cache line of padding **/
+  static constexpr size_t SLOTS_OFFSET =
+    ((sizeof(Header) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE + 1) * CACHE_LINE_SIZE;
+
+  [[nodiscard]] static size_t region_size(size_t capacity) noexcept
+  {
+    return SLOTS_OFFSET + (capacity * sizeof(value_type)) + CACHE_LINE_SIZE;
+  }
+
+  /**
+   * Reloads the min read index of the readers, the scan is published to the joining readers the
+   * same way as SPBroadcastQueue does, see ReadIdxScan
+   */
+  [[nodiscard]] size_t _load_min_read_idx() noexcept
+  {
+    return _header->read_idx_scan.scan(
+      [this]()
+      {
+        size_t min_read_idx = _header->read_idx[0].load(std::memory_order_relaxed);
+
+        for (size_t i = 1; i < MAX_READERS; ++i)
+        {
+          min_read_idx = std::min(min_read_idx, _header->read_idx[i].load(std::memory_order_relaxed));
+        }
+
+        return min_read_idx;
+      });
+  }
+
+  /**
+   * Publishes the read index of a joining reader, moving it up to the min read index the producer
+   * last loaded, see ReadIdxScan
+   * @return the read index the reader starts from
+   */
+  [[nodiscard]] size_t _join(size_t reader_id, size_t read_idx) noexcept
+  {
+    return _header->read_idx_scan.join(_header->read_idx[reader_id], read_idx, _header->write_idx);
+  }
+
+  /**
+   * Stops the producer from waiting for the reader, then frees the slot so it can be claimed again
+   */
+  void _release_reader(size_t reader_id) noexcept
+  {
+    _header->read_idx[reader_id].store(std::numeric_limits<size_t>::max(), std::memory_order_release);
+    _header->owner_pid[reader_id].store(FREE_READER, std::memory_order_release);
+  }
+
+  void _map(int fd)
+  {
+    void* region = ::mmap(nullptr, _region_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int const error = errno;
+    ::close(fd);
+
+    if (region == MAP_FAILED)
+    {
+      if (_is_owner)
+      {
+        ::shm_unlink(_name.c_str());
+      }
+
+      throw std::runtime_error{"mmap failed, error: " + std::string{std::strerror(error)}};
+    }
+
+    _region = static_cast<std::byte*>(region);
+  }
+
+  void _init_local() noexcept
+  {
+    _capacity = _header->capacity;
+    _capacity_minus_one = _capacity - 1;
+    _items_per_batch_minus_one = _header->items_per_batch_minus_one;
+    _slots = reinterpret_cast<value_type*>(_region + SLOTS_OFFSET);
+
+    for (size_t i = 0; i < MAX_READERS; ++i)
+    {
+      _reader_cache[i].reset();
+    }
+  }
+
+private:
+  /** Members **/
+  std::string _name;
+  bool _is_owner;
+  std::byte* _region = nullptr;
+  size_t _region_size{0};
+  Header* _header = nullptr;
+  size_t _capacity{0};
+  size_t _capacity_minus_one{0};
+  size_t _items_per_batch_minus_one{0};
+  value_type* _slots = nullptr;
+
+  WaitStrategy _wait_strategy;
+
+  alignas(CACHE_LINE_SIZE) size_t _min_read_idx_cache = std::numeric_limits<size_t>::max();
+  alignas(CACHE_LINE_SIZE) std::array<ReaderCache, MAX_READERS> _reader_cache;
+};
+} // namespace lockfree_queues
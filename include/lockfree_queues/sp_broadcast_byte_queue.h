@@ -0,0 +1,384 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+#include "lockfree_queues/utilities.h"
+
+namespace lockfree_queues
+{
+
+/***
+ * A bounded single-producer multiple-consumer broadcast queue of variable length records.
+ *
+ * It follows the same protocol as SPBroadcastQueue, but instead of fixed size slots the records
+ * are stored contiguously in a byte ring buffer, each one prefixed by its length. A record never
+ * wraps around the end of the buffer; when it does not fit, a padding record fills the rest of the
+ * buffer and the record is written at the start.
+ *
+ * All consumers see all the records. Consumers first "subscribe()" and will then see the
+ * records published after subscribing.
+ *
+ * As with SPBroadcastQueue, the producer and the consumers cache the indexes locally and the
+ * consumers commit their read index in batches.
+ *
+ * @tparam MAX_READERS Max consumers that can subscribe to this queue
+ * @tparam Allocator An allocator used to allocate memory
+ */
+template <size_t MAX_READERS = 1, typename Allocator = std::allocator<std::byte>>
+class SPBroadcastByteQueue
+{
+public:
+  /**
+   * A record in the queue memory
+   */
+  struct Record
+  {
+    std::byte const* data{nullptr};
+    size_t size{0};
+  };
+
+  /**
+   * Constructor
+   * @param capacity Max capacity in bytes
+   * @param reader_batch_size Readers commit their reads to the producer in batches to increase
+   * throughput, it must be at least 2
+   * @param allocator memory allocator
+   */
+  explicit SPBroadcastByteQueue(size_t capacity, size_t reader_batch_size = 4,
+                                Allocator const& allocator = Allocator())
+    : _capacity(std::max(size_t{256}, next_power_of_two(capacity))),
+      _capacity_minus_one(_capacity - 1),
+      _items_per_batch_minus_one(_bytes_per_batch(_capacity, reader_batch_size) - 1),
+      _max_record_size(((_capacity - (_items_per_batch_minus_one + 1)) / 2) - HEADER_SIZE),
+      _allocator(allocator)
+  {
+    // we add some padding to the start and end of the buffer to protect it from false sharing
+    // --- padding --- | --- records ---- | --- padding --- |
+    _buffer = std::allocator_traits<Allocator>::allocate(_allocator, _capacity + (2u * CACHE_LINE_SIZE));
+    _records = _buffer + CACHE_LINE_SIZE;
+
+    for (size_t i = 0; i < MAX_READERS; ++i)
+    {
+      _reader_cache[i].reset();
+    }
+
+    for (size_t i = 0; i < MAX_READERS; ++i)
+    {
+      _read_idx[i].store(std::numeric_limits<size_t>::max());
+    }
+
+    _write_idx.store(0);
+    _subscribe_lock.store(false);
+  }
+
+  ~SPBroadcastByteQueue()
+  {
+    std::allocator_traits<Allocator>::deallocate(_allocator, _buffer, _capacity + (2u * CACHE_LINE_SIZE));
+  }
+
+  /** Deleted **/
+  SPBroadcastByteQueue(SPBroadcastByteQueue const&) = delete;
+  SPBroadcastByteQueue& operator=(SPBroadcastByteQueue const&) = delete;
+
+  /**
+   * Copies a record of size bytes to the queue, waiting until there is space
+   * @throws std::invalid_argument if size is greater than max_record_size()
+   */
+  void push(void const* data, size_t size)
+  {
+    if (size > _max_record_size)
+    {
+      throw std::invalid_argument{"record size greater than max record size"};
+    }
+
+    while (!try_push(data, size))
+    {
+      // retry
+    }
+  }
+
+  /**
+   * Copies a record of size bytes to the queue
+   * @param size record size, a record greater than max_record_size() never fits and the caller has
+   * to check it first
+   * @return false if the queue is full or the record is greater than max_record_size()
+   */
+  [[nodiscard]] bool try_push(void const* data, size_t size) noexcept
+  {
+    std::byte* record = try_reserve(size);
+
+    if (!record)
+    {
+      return false;
+    }
+
+    std::memcpy(record, data, size);
+    commit();
+
+    return true;
+  }
+
+  /**
+   * Reserves a record of size bytes without publishing it. The record must be written in the
+   * returned storage and then published with commit()
+   * @param size record size, a record greater than max_record_size() never fits and the caller has
+   * to check it first
+   * @return pointer to the storage of the record or nullptr when the queue is full or the record is
+   * greater than max_record_size()
+   */
+  [[gnu::hot, nodiscard]] std::byte* try_reserve(size_t size) noexcept
+  {
+    if (size > _max_record_size)
+    {
+      return nullptr;
+    }
+
+    size_t const record_size = aligned_record_size(size);
+    size_t write_idx = _write_idx.load(std::memory_order_relaxed);
+    size_t const offset = write_idx & _capacity_minus_one;
+    size_t const padding = (offset + record_size > _capacity) ? (_capacity - offset) : 0;
+
+    if (!_has_space(write_idx, padding + record_size))
+    {
+      return nullptr;
+    }
+
+    if (padding != 0)
+    {
+      // the record does not fit until the end of the buffer, fill the rest with padding
+      _write_header(write_idx, PADDING_FLAG | padding);
+      write_idx += padding;
+    }
+
+    _write_header(write_idx, size);
+    _pending_write_idx = write_idx + record_size;
+
+    return &_records[(write_idx & _capacity_minus_one) + HEADER_SIZE];
+  }
+
+  /**
+   * Publishes the record previously reserved with try_reserve()
+   */
+  [[gnu::always_inline, gnu::hot]] void commit() noexcept
+  {
+    _write_idx.store(_pending_write_idx, std::memory_order_release);
+  }
+
+  /**
+   * @return the next record of the reader, or a record with nullptr data when the queue is empty
+   */
+  [[gnu::hot, nodiscard]] Record front(size_t reader_id) noexcept
+  {
+    ReaderCache& reader_cache = _reader_cache[reader_id];
+
+    if (reader_cache.read_local_idx == reader_cache.write_idx_cache)
+    {
+      reader_cache.write_idx_cache = _write_idx.load(std::memory_order_acquire);
+      if (reader_cache.read_local_idx == reader_cache.write_idx_cache)
+      {
+        return Record{};
+      }
+    }
+
+    size_t header = _read_header(reader_cache.read_local_idx);
+
+    if (header & PADDING_FLAG)
+    {
+      // padding is always published together with the record that follows it
+      _advance(reader_id, header & ~PADDING_FLAG);
+      header = _read_header(reader_cache.read_local_idx);
+    }
+
+    return Record{&_records[(reader_cache.read_local_idx & _capacity_minus_one) + HEADER_SIZE], header};
+  }
+
+  /**
+   * Consumes the record returned by the last front()
+   */
+  [[gnu::hot]] void pop(size_t reader_id) noexcept
+  {
+    _advance(reader_id, aligned_record_size(_read_header(_reader_cache[reader_id].read_local_idx)));
+  }
+
+  [[nodiscard]] size_t capacity() const noexcept { return _capacity; }
+
+  /**
+   * @return the max size of a single record
+   */
+  [[nodiscard]] size_t max_record_size() const noexcept { return _max_record_size; }
+
+  [[nodiscard]] size_t subscribe()
+  {
+    while (_subscribe_lock.exchange(true))
+    {
+      // wait for the lock
+    }
+
+    auto search_it = std::find_if(std::begin(_read_idx), std::end(_read_idx),
+                                  [](auto const& reader_idx)
+                                  {
+                                    return reader_idx.load(std::memory_order_acquire) ==
+                                      std::numeric_limits<size_t>::max();
+                                  });
+
+    if (search_it == std::end(_read_idx))
+    {
+      _subscribe_lock.store(false);
+      throw std::runtime_error{"Max consumers reached"};
+    }
+
+    size_t const index = std::distance(std::begin(_read_idx), search_it);
+
+    // records are not fixed size, so the reader starts at the next record
+    size_t const write_idx = _write_idx.load(std::memory_order_acquire);
+
+    _reader_cache[index].set(write_idx);
+    _read_idx[index].store(write_idx, std::memory_order_release);
+    _subscribe_lock.store(false);
+    return index;
+  }
+
+  void unsubscribe(size_t reader_id) noexcept
+  {
+    while (_subscribe_lock.exchange(true))
+    {
+      // wait for the lock
+    }
+
+    _reader_cache[reader_id].reset();
+    _read_idx[reader_id].store(std::numeric_limits<size_t>::max(), std::memory_order_release);
+    _subscribe_lock.store(false);
+  }
+
+private:
+  static_assert(MAX_READERS != 0, "MAX_READERS can not be zero");
+
+  static constexpr size_t CACHE_LINE_SIZE{128u};
+
+  /** Each record is prefixed by its size, and records are aligned to the header size **/
+  static constexpr size_t HEADER_SIZE{sizeof(size_t)};
+  static constexpr size_t PADDING_FLAG{size_t{1} << (sizeof(size_t) * 8u - 1u)};
+
+  struct ReaderCache
+  {
+    void set(size_t v) noexcept
+    {
+      read_local_idx = v;
+      write_idx_cache = v;
+    }
+
+    void reset() noexcept { set(std::numeric_limits<size_t>::max()); }
+
+    alignas(CACHE_LINE_SIZE) size_t read_local_idx{std::numeric_limits<size_t>::max()};
+    size_t write_idx_cache{std::numeric_limits<size_t>::max()};
+  };
+
+  /**
+   * Validates the reader batch size before the members are computed from it
+   * @return the bytes between two commits of the read index
+   */
+  [[nodiscard]] static size_t _bytes_per_batch(size_t capacity, size_t reader_batch_size)
+  {
+    if (reader_batch_size < 2)
+    {
+      throw std::runtime_error{"reader batch size must be at least 2"};
+    }
+
+    size_t const bytes_per_batch = capacity / reader_batch_size;
+
+    if (!is_power_of_two(bytes_per_batch))
+    {
+      throw std::runtime_error{"items per batch must be power of 2"};
+    }
+
+    return bytes_per_batch;
+  }
+
+  [[nodiscard]] static constexpr size_t aligned_record_size(size_t size) noexcept
+  {
+    return (HEADER_SIZE + size + HEADER_SIZE - 1) & ~(HEADER_SIZE - 1);
+  }
+
+  [[gnu::always_inline]] void _write_header(size_t idx, size_t header) noexcept
+  {
+    std::memcpy(&_records[idx & _capacity_minus_one], &header, HEADER_SIZE);
+  }
+
+  [[gnu::always_inline, nodiscard]] size_t _read_header(size_t idx) const noexcept
+  {
+    size_t header;
+    std::memcpy(&header, &_records[idx & _capacity_minus_one], HEADER_SIZE);
+    return header;
+  }
+
+  /**
+   * Checks if n bytes can be written, reloading the read indexes of the readers only when the
+   * cached min read index does not leave enough space
+   */
+  [[gnu::always_inline, nodiscard]] bool _has_space(size_t write_idx, size_t n) noexcept
+  {
+    if ((_min_read_idx_cache == std::numeric_limits<size_t>::max()) ||
+        ((write_idx + n - _min_read_idx_cache) > _capacity))
+    {
+      _min_read_idx_cache = _read_idx[0].load(std::memory_order_acquire);
+
+      if constexpr (MAX_READERS > 1)
+      {
+        // Find the min read_idx if more than one reader
+        for (size_t i = 1; i < _read_idx.size(); ++i)
+        {
+          _min_read_idx_cache = std::min(_min_read_idx_cache, _read_idx[i].load(std::memory_order_acquire));
+        }
+      }
+
+      if ((_min_read_idx_cache == std::numeric_limits<size_t>::max()) ||
+          ((write_idx + n - _min_read_idx_cache) > _capacity))
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Moves the reader forward by n bytes, committing the read index when a batch boundary is crossed
+   */
+  [[gnu::always_inline]] void _advance(size_t reader_id, size_t n) noexcept
+  {
+    size_t const prev_read_local_idx = _reader_cache[reader_id].read_local_idx;
+    size_t const read_local_idx = prev_read_local_idx + n;
+    _reader_cache[reader_id].read_local_idx = read_local_idx;
+
+    if ((read_local_idx & ~_items_per_batch_minus_one) != (prev_read_local_idx & ~_items_per_batch_minus_one))
+    {
+      _read_idx[reader_id].store(read_local_idx, std::memory_order_release);
+    }
+  }
+
+private:
+  /** Members **/
+  size_t _capacity;
+  size_t _capacity_minus_one;
+  size_t _items_per_batch_minus_one;
+  size_t _max_record_size;
+  std::byte* _records = nullptr;
+  std::byte* _buffer = nullptr;
+  std::atomic<bool> _subscribe_lock;
+  Allocator _allocator;
+
+  alignas(CACHE_LINE_SIZE) std::atomic<size_t> _write_idx = {0};
+  alignas(CACHE_LINE_SIZE) size_t _min_read_idx_cache = std::numeric_limits<size_t>::max();
+  size_t _pending_write_idx{0};
+  alignas(CACHE_LINE_SIZE) std::array<std::atomic<size_t>, MAX_READERS> _read_idx;
+  alignas(CACHE_LINE_SIZE) std::array<ReaderCache, MAX_READERS> _reader_cache;
+};
+} // namespace lockfree_queues
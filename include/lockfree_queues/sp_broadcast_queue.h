@@ -3,17 +3,96 @@
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <iterator>
 #include <limits>
 #include <memory>
 #include <stdexcept>
 #include <type_traits>
 
+#include "lockfree_queues/read_idx_scan.h"
 #include "lockfree_queues/utilities.h"
+#include "lockfree_queues/wait_strategy.h"
 
 namespace lockfree_queues
 {
 
+/**
+ * What the producer does when the slowest reader is a whole capacity behind
+ */
+enum class OverflowPolicy
+{
+  /** The producer waits for the slowest reader **/
+  Block,
+
+  /** The producer always advances and overwrites the oldest elements, lapped readers lose them **/
+  Overwrite
+};
+
+/**
+ * How the readers find out that the producer published an element
+ */
+enum class PublishPolicy
+{
+  /** The readers load the write index of the producer **/
+  WriteIndex,
+
+  /** Each slot carries a sequence number, the readers poll the sequence of the next slot **/
+  SlotSequence
+};
+
+/**
+ * Where a new reader starts reading from
+ */
+enum class SubscribeFrom
+{
+  /** The last element written **/
+  Latest,
+
+  /** The oldest element still in the queue, replaying the history the queue retains **/
+  Oldest
+};
+
+/**
+ * Whether the queue collects counters about its usage
+ */
+enum class Telemetry
+{
+  /** No counters, no storage and no cost **/
+  Disabled,
+
+  /** The producer and the readers maintain counters, read with producer_stats() and reader_stats() **/
+  Enabled
+};
+
+/**
+ * Whether the producer can evict the readers lagging too far behind, see set_max_reader_lag()
+ */
+enum class Eviction
+{
+  /** The producer always waits for the slowest reader, the readers never check for an eviction **/
+  Disabled,
+
+  /** The producer evicts the readers lagging more than the max reader lag when the queue is full **/
+  Enabled
+};
+
+/** MAX_READERS of a queue whose max number of readers is given to the constructor **/
+constexpr size_t DYNAMIC_READERS = std::numeric_limits<size_t>::max();
+
+/**
+ * How the read indexes the readers commit to the producer are laid out in memory
+ */
+enum class ReadIndexLayout
+{
+  /** The read indexes are packed together, the producer scans fewer cache lines **/
+  Packed,
+
+  /** Each read index has its own cache line, the commits of the readers do not false share **/
+  Padded
+};
+
 /***
  * A bounded single-producer multiple-consumer queue.
  * The queue can function as both a Single-Producer, Single-Consumer (SPSC) queue and
@@ -25,6 +104,13 @@ namespace lockfree_queues
  * To use this queue, consumers need to first "subscribe()" to it, and then they can start
  * consuming messages.
  * Importantly, all consumers will see all the messages in the queue.
+ * Subscribing and unsubscribing are lock-free, consumers can join while the producer is running.
+ *
+ * Consumers can also join a consumer group with "subscribe_group()". The members of a group share a
+ * claim cursor and each message is claimed by exactly one member with "try_claim()", so a group
+ * load-balances the stream between its members while every other reader or group still sees the
+ * whole stream. The producer writes each message once and waits for the slowest member, a member
+ * must therefore keep polling for as long as it is subscribed.
  *
  * In addition, special attention has been given to optimizing the queue to avoid performance
  * bottlenecks, such as false sharing and cache issues. This optimization leads to increased
@@ -35,17 +121,114 @@ namespace lockfree_queues
  * Moreover, consumers will update their index after consuming multiple messages,
  * rather than updating it each time. By default, the queue is split into four batches
  *
+ * With Eviction::Enabled and set_max_reader_lag(), the producer evicts the readers lagging too far
+ * behind when the queue is full instead of waiting for them, so a stuck reader does not stall the
+ * others. front() then returns nullptr both when the queue is empty and when the reader was
+ * evicted, a reader tells them apart by checking evicted() whenever front() returns nullptr. With
+ * Eviction::Disabled, the default, front() and pop() do not check for an eviction at all.
+ *
+ * With OverflowPolicy::Overwrite the producer never waits for the readers. Each slot carries a
+ * seqlock style sequence number, a reader that was lapped by the producer finds out in front(),
+ * skips to the oldest element still in the queue and counts the elements it lost. As an element
+ * can be overwritten while it is read, the reader must copy it and check the copy with
+ * validate() before pop(). T must be trivially copyable in this mode.
+ *
+ * With PublishPolicy::SlotSequence the producer also stamps a sequence number on each slot it
+ * publishes, in an array next to the slots, and front() polls the sequences of the next slots
+ * instead of reloading the write index. It caches the furthest consecutive published element so
+ * the following calls to front() do not load any sequence. The producer still updates the write
+ * index, which subscribe(), read_available() and try_claim() load.
+ *
+ * With ReadIndexLayout::Padded the read index each reader commits in pop() sits on its own cache
+ * line instead of sharing it with the read indexes of the other readers, at the cost of one cache
+ * line per reader for the producer to load when the queue looks full.
+ *
+ * With MAX_READERS set to DYNAMIC_READERS the max number of readers is given to the constructor
+ * and the reader tables are allocated at runtime. In both cases the producer only scans the read
+ * indexes of the subscribed readers, tracked in a bitmap, when the queue looks full.
+ *
+ * With Telemetry::Enabled the producer and each reader count what they do in counters only they
+ * write, which any thread can read with producer_stats() and reader_stats().
  *
  * @tparam T Type of th element
- * @tparam MAX_READERS Max consumers that can subscribe to this queue
+ * @tparam MAX_READERS Max consumers that can subscribe to this queue or DYNAMIC_READERS
  * @tparam Allocator An allocator used to allocate memory
+ * @tparam WaitStrategy What the producer does while the queue is full and the consumers do while it
+ * is empty in the blocking emplace() and front_wait() calls
+ * @tparam OVERFLOW_POLICY Whether the producer waits for the slowest reader or overwrites
+ * @tparam PUBLISH_POLICY Whether front() polls the write index or the sequence of the next slot
+ * @tparam READ_INDEX_LAYOUT Whether the read indexes of the readers share cache lines
+ * @tparam TELEMETRY Whether the producer and the readers collect counters
+ * @tparam EVICTION Whether the producer can evict the readers lagging too far behind
  */
-template <typename T, size_t MAX_READERS = 1, typename Allocator = std::allocator<T>>
+template <typename T, size_t MAX_READERS = 1, typename Allocator = std::allocator<T>,
+          typename WaitStrategy = BusySpinWaitStrategy, OverflowPolicy OVERFLOW_POLICY = OverflowPolicy::Block,
+          PublishPolicy PUBLISH_POLICY = PublishPolicy::WriteIndex, ReadIndexLayout READ_INDEX_LAYOUT = ReadIndexLayout::Packed,
+          Telemetry TELEMETRY = Telemetry::Disabled, Eviction EVICTION = Eviction::Disabled>
 class SPBroadcastQueue
 {
 public:
   using value_type = T;
 
+  /**
+   * A contiguous range of elements in the queue memory
+   */
+  struct Span
+  {
+    [[nodiscard]] value_type const* begin() const noexcept { return data; }
+    [[nodiscard]] value_type const* end() const noexcept { return data + size; }
+
+    value_type const* data{nullptr};
+    size_t size{0};
+  };
+
+  /**
+   * The elements available to a reader. They are split in two spans when they wrap around the
+   * end of the buffer, otherwise second is empty
+   */
+  struct ReadView
+  {
+    [[nodiscard]] size_t size() const noexcept { return first.size + second.size; }
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+    Span first;
+    Span second;
+  };
+
+  /**
+   * The counters of the producer, see Telemetry
+   */
+  struct ProducerStats
+  {
+    /** Elements written **/
+    size_t written{0};
+
+    /** Attempts to write that failed because the queue was full **/
+    size_t full{0};
+
+    /** Times the producer reloaded the read indexes of the readers **/
+    size_t min_read_idx_reloads{0};
+
+    /** Elements not yet read by the slowest reader **/
+    size_t depth{0};
+
+    /** The max depth, sampled each time the producer reloads the read indexes **/
+    size_t max_depth{0};
+  };
+
+  /**
+   * The counters of a reader, see Telemetry
+   */
+  struct ReaderStats
+  {
+    /** Elements written and not yet committed as read by the reader, readers do not commit their
+     * reads with OverflowPolicy::Overwrite **/
+    size_t lag{0};
+
+    /** Polls that found no element **/
+    size_t empty_polls{0};
+  };
+
   /**
    * Constructor
    * @param capacity Max element capacity
@@ -54,33 +237,23 @@ public:
    */
   explicit SPBroadcastQueue(size_t capacity, size_t reader_batch_size = 4,
                             Allocator const& allocator = Allocator())
-    : _capacity(std::max(size_t{16}, next_power_of_two(capacity))),
-      _capacity_minus_one(_capacity - 1),
-      _items_per_batch_minus_one((_capacity / reader_batch_size) - 1),
-      _allocator(allocator)
+    : SPBroadcastQueue(capacity, reader_batch_size, allocator, MAX_READERS)
   {
-    if (!is_power_of_two(_items_per_batch_minus_one + 1))
-    {
-      throw std::runtime_error{"items per batch must be power of 2"};
-    }
-
-    // we add some padding to the start and end of the buffer to protect it from false sharing
-    // --- padding --- | --- slots* ---- | --- padding --- |
-    _buffer = std::allocator_traits<Allocator>::allocate(_allocator, _capacity + (2u * PADDING));
-    _slots = _buffer + PADDING;
-
-    for (size_t i = 0; i < MAX_READERS; ++i)
-    {
-      _reader_cache[i].reset();
-    }
-
-    for (size_t i = 0; i < MAX_READERS; ++i)
-    {
-      _read_idx[i].store(std::numeric_limits<size_t>::max());
-    }
+    static_assert(MAX_READERS != DYNAMIC_READERS, "DYNAMIC_READERS requires max_readers");
+  }
 
-    _write_idx.store(0);
-    _subscribe_lock.store(false);
+  /**
+   * Constructor of a queue with DYNAMIC_READERS
+   * @param capacity Max element capacity
+   * @param max_readers Max consumers that can subscribe to this queue
+   * @param reader_batch_size Readers commit their reads to the producer in batches to increase throughput
+   * @param allocator memory allocator
+   */
+  SPBroadcastQueue(size_t capacity, size_t max_readers, size_t reader_batch_size,
+                   Allocator const& allocator = Allocator())
+    : SPBroadcastQueue(capacity, reader_batch_size, allocator, max_readers)
+  {
+    static_assert(MAX_READERS == DYNAMIC_READERS, "max_readers requires DYNAMIC_READERS");
   }
 
   /**
@@ -96,6 +269,12 @@ public:
       _slots[i].~T();
     }
 
+    if constexpr (HAS_SLOT_SEQUENCES)
+    {
+      sequence_allocator_type sequence_allocator{_allocator};
+      std::allocator_traits<sequence_allocator_type>::deallocate(sequence_allocator, _sequences, _capacity);
+    }
+
     std::allocator_traits<Allocator>::deallocate(_allocator, _buffer, _capacity + (2u * PADDING));
   }
 
@@ -106,159 +285,1081 @@ public:
   template <typename... Args>
   [[gnu::always_inline, gnu::hot]] void emplace(Args&&... args)
   {
-    while (!try_emplace(std::forward<Args>(args)...))
+    for (uint32_t attempt = 0; !try_emplace(std::forward<Args>(args)...); ++attempt)
     {
-      // retry
+      _wait_strategy.wait(attempt);
     }
   }
 
   template <typename... Args>
   [[gnu::always_inline, gnu::hot, nodiscard]] bool try_emplace(Args&&... args)
   {
+    value_type* slot = try_reserve();
+
+    if (!slot)
+    {
+      return false;
+    }
+
+    ::new (static_cast<void*>(slot)) value_type{std::forward<Args>(args)...};
+    commit();
+
+    return true;
+  }
+
+  /**
+   * Reserves the next slot for writing without publishing it, allowing the producer to
+   * construct the element directly in the queue memory.
+   * A value_type must be constructed in the returned storage (e.g. using placement new) and then
+   * published with commit() before try_reserve() is called again.
+   * @return pointer to the uninitialised storage of the next slot or nullptr when the queue is full
+   */
+  [[gnu::always_inline, gnu::hot, nodiscard]] value_type* try_reserve() noexcept
+  {
+    size_t const write_idx = _write_idx.load(std::memory_order_relaxed);
+
+    if (!_has_space(write_idx, 1))
+    {
+      _count(_producer_counters.full, 1);
+      return nullptr;
+    }
+
+    return _prepare_slot(write_idx);
+  }
+
+  /**
+   * Publishes the element previously constructed in the slot returned by try_reserve()
+   */
+  [[gnu::always_inline, gnu::hot]] void commit() noexcept
+  {
+    size_t const write_idx = _write_idx.load(std::memory_order_relaxed);
+    _publish_slot(write_idx);
+    _write_idx.store(write_idx + 1, std::memory_order_release);
+    _wait_strategy.notify();
+    _count(_producer_counters.written, 1);
+  }
+
+  /**
+   * Constructs all the elements of the range [first, last) and publishes them together with a
+   * single update of the write index. Either all the elements are written or none.
+   * @return false if there is not enough space for the whole range
+   */
+  template <typename ForwardIt>
+  [[gnu::hot, nodiscard]] bool try_emplace_n(ForwardIt first, ForwardIt last)
+  {
+    size_t const n = static_cast<size_t>(std::distance(first, last));
+
+    if (n == 0)
+    {
+      return true;
+    }
+
     size_t const write_idx = _write_idx.load(std::memory_order_relaxed);
 
-    if ((_min_read_idx_cache == std::numeric_limits<size_t>::max()) ||
-        ((write_idx - _min_read_idx_cache) == _capacity))
+    if (!_has_space(write_idx, n))
+    {
+      _count(_producer_counters.full, 1);
+      return false;
+    }
+
+    for (size_t i = 0; i < n; ++i, ++first)
+    {
+      ::new (static_cast<void*>(_prepare_slot(write_idx + i))) value_type{*first};
+      _publish_slot(write_idx + i);
+    }
+
+    _write_idx.store(write_idx + n, std::memory_order_release);
+    _wait_strategy.notify();
+    _count(_producer_counters.written, n);
+
+    return true;
+  }
+
+  /**
+   * @return the next element of the reader or nullptr when there is none. With Eviction::Enabled,
+   * nullptr is also returned once the reader was evicted, check evicted() on every nullptr.
+   */
+  [[gnu::always_inline, gnu::hot, nodiscard]] value_type const* front(size_t reader_id) noexcept
+  {
+    if (_is_evicted(reader_id))
     {
-      _min_read_idx_cache = _read_idx[0].load(std::memory_order_acquire);
+      return nullptr;
+    }
 
-      if constexpr (MAX_READERS > 1)
+    if (_reader_cache[reader_id].read_local_idx == _reader_cache[reader_id].write_idx_cache)
+    {
+      if constexpr (PUBLISH_POLICY == PublishPolicy::SlotSequence)
       {
-        // Find the min read_idx if more than one reader
-        for (size_t i = 1; i < _read_idx.size(); ++i)
+        size_t const published_end = _published_end(_reader_cache[reader_id].read_local_idx);
+        if (published_end == _reader_cache[reader_id].read_local_idx)
         {
-          _min_read_idx_cache = std::min(_min_read_idx_cache, _read_idx[i].load(std::memory_order_acquire));
+          _count(_reader_cache[reader_id].empty_polls, 1);
+          return nullptr;
         }
-      }
 
-      if ((_min_read_idx_cache == std::numeric_limits<size_t>::max()) ||
-          ((write_idx - _min_read_idx_cache) == _capacity))
+        // a single fence for all the elements found published
+        std::atomic_thread_fence(std::memory_order_acquire);
+        _reader_cache[reader_id].write_idx_cache = published_end;
+      }
+      else
       {
-        return false;
+        _reader_cache[reader_id].write_idx_cache = _write_idx.load(std::memory_order_acquire);
+        if (_reader_cache[reader_id].read_local_idx == _reader_cache[reader_id].write_idx_cache)
+        {
+          _count(_reader_cache[reader_id].empty_polls, 1);
+          return nullptr;
+        }
       }
     }
 
-    value_type* slot = &_slots[write_idx & _capacity_minus_one];
-
-    if constexpr (!std::is_trivially_destructible_v<value_type>)
+    if constexpr (OVERFLOW_POLICY == OverflowPolicy::Overwrite)
     {
-      if (_write_idx >= _capacity)
+      if (!_is_published(_reader_cache[reader_id].read_local_idx, std::memory_order_acquire))
       {
-        // do not call the destructor until we have wrapped around at least once
-        slot->~value_type();
+        _resync(reader_id);
       }
     }
 
-    ::new (static_cast<void*>(slot)) value_type{std::forward<Args>(args)...};
-    _write_idx.store(write_idx + 1, std::memory_order_release);
+    return reinterpret_cast<value_type const*>(&_slots[_reader_cache[reader_id].read_local_idx & _capacity_minus_one]);
+  }
 
-    return true;
+  /**
+   * Checks that the element returned by the last front() was not overwritten by the producer while
+   * it was read. Only available with OverflowPolicy::Overwrite.
+   * @return true if the copy of the element taken after front() is intact, otherwise the element
+   * is lost and the next front() skips it
+   */
+  [[gnu::always_inline, gnu::hot, nodiscard]] bool validate(size_t reader_id) const noexcept
+  {
+    static_assert(OVERFLOW_POLICY == OverflowPolicy::Overwrite, "validate requires OverflowPolicy::Overwrite");
+
+    // order the reads of the element before the reload of the sequence
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return _is_published(_reader_cache[reader_id].read_local_idx, std::memory_order_relaxed);
   }
 
-  [[gnu::always_inline, gnu::hot, nodiscard]] value_type const* front(size_t reader_id) noexcept
+  /**
+   * @return the number of elements the reader lost because the producer overwrote them. Only
+   * available with OverflowPolicy::Overwrite.
+   */
+  [[nodiscard]] size_t lost_count(size_t reader_id) const noexcept
   {
-    if (_reader_cache[reader_id].read_local_idx == _reader_cache[reader_id].write_idx_cache)
+    static_assert(OVERFLOW_POLICY == OverflowPolicy::Overwrite, "lost_count requires OverflowPolicy::Overwrite");
+    return _reader_cache[reader_id].lost_count;
+  }
+
+  /**
+   * Waits using the WaitStrategy until an element is available to the reader
+   * @return the element or nullptr if the reader was evicted
+   */
+  [[nodiscard]] value_type const* front_wait(size_t reader_id) noexcept
+  {
+    value_type const* item = front(reader_id);
+
+    for (uint32_t attempt = 0; !item && !_is_evicted(reader_id); ++attempt)
+    {
+      _wait_strategy.wait_for_data(attempt, [this, reader_id]() { return _has_data_or_evicted(reader_id); });
+      item = front(reader_id);
+    }
+
+    return item;
+  }
+
+  /**
+   * Waits using the WaitStrategy until an element is available to the reader or the timeout expires
+   * @return the element or nullptr on timeout or if the reader was evicted
+   */
+  template <typename Rep, typename Period>
+  [[nodiscard]] value_type const* front_wait(size_t reader_id, std::chrono::duration<Rep, Period> timeout) noexcept
+  {
+    value_type const* item = front(reader_id);
+
+    if (item)
+    {
+      return item;
+    }
+
+    auto const deadline = std::chrono::steady_clock::now() + timeout;
+
+    for (uint32_t attempt = 0;; ++attempt)
     {
-      _reader_cache[reader_id].write_idx_cache = _write_idx.load(std::memory_order_acquire);
-      if (_reader_cache[reader_id].read_local_idx == _reader_cache[reader_id].write_idx_cache)
+      _wait_strategy.wait_for_data(attempt, [this, reader_id]() { return _has_data_or_evicted(reader_id); });
+
+      item = front(reader_id);
+      if (item || _is_evicted(reader_id) || (std::chrono::steady_clock::now() >= deadline))
       {
-        return nullptr;
+        return item;
       }
     }
-
-    return reinterpret_cast<value_type const*>(&_slots[_reader_cache[reader_id].read_local_idx & _capacity_minus_one]);
   }
 
   [[gnu::always_inline, gnu::hot]] void pop(size_t reader_id) noexcept
   {
     _reader_cache[reader_id].read_local_idx += 1;
 
-    if ((_reader_cache[reader_id].read_local_idx & _items_per_batch_minus_one) == 0)
+    if constexpr (OVERFLOW_POLICY == OverflowPolicy::Block)
     {
-      _read_idx[reader_id].store(_reader_cache[reader_id].read_local_idx, std::memory_order_release);
+      if ((_reader_cache[reader_id].read_local_idx & _items_per_batch_minus_one) == 0)
+      {
+        _commit_read_idx(reader_id, _reader_cache[reader_id].read_local_idx);
+      }
     }
   }
 
-  [[nodiscard]] size_t capacity() const noexcept { return _capacity; }
-
-  [[nodiscard]] size_t subscribe()
+  /**
+   * Returns all the elements currently available to the reader. The elements remain valid until
+   * they are consumed with pop_n()
+   */
+  [[gnu::hot, nodiscard]] ReadView read_available(size_t reader_id) noexcept
   {
-    while (_subscribe_lock.exchange(true))
+    static_assert(OVERFLOW_POLICY == OverflowPolicy::Block, "read_available requires OverflowPolicy::Block");
+
+    if (_is_evicted(reader_id))
     {
-      // wait for the lock
+      return ReadView{};
     }
 
-    auto search_it = std::find_if(std::begin(_read_idx), std::end(_read_idx),
-                                  [](auto const& reader_idx)
-                                  {
-                                    return reader_idx.load(std::memory_order_acquire) ==
-                                      std::numeric_limits<size_t>::max();
-                                  });
+    ReaderCache& reader_cache = _reader_cache[reader_id];
+    reader_cache.write_idx_cache = _write_idx.load(std::memory_order_acquire);
+
+    size_t const available = reader_cache.write_idx_cache - reader_cache.read_local_idx;
 
-    if (search_it == std::end(_read_idx))
+    if (available == 0)
     {
-      _subscribe_lock.store(false);
-      throw std::runtime_error{"Max consumers reached"};
+      _count(reader_cache.empty_polls, 1);
     }
+    size_t const start = reader_cache.read_local_idx & _capacity_minus_one;
+    size_t const first_size = std::min(available, _capacity - start);
 
-    size_t const index = std::distance(std::begin(_read_idx), search_it);
-    size_t const write_idx = _write_idx.load(std::memory_order_acquire);
-    size_t const last_write_idx = (write_idx == 0) ? 0 : write_idx - 1;
+    return ReadView{Span{&_slots[start], first_size}, Span{_slots, available - first_size}};
+  }
 
-    _reader_cache[index].set(last_write_idx);
-    _read_idx[index].store(last_write_idx, std::memory_order_release);
-    _subscribe_lock.store(false);
-    return index;
+  /**
+   * Consumes n elements, n must not be greater than the size of the last read_available() view
+   */
+  [[gnu::hot]] void pop_n(size_t reader_id, size_t n) noexcept
+  {
+    _advance(reader_id, _reader_cache[reader_id].read_local_idx + n);
   }
 
-  void unsubscribe(size_t reader_id) noexcept
+  /**
+   * Claims the next element of the consumer group of the reader, so that no other member of the
+   * group sees it. The element remains valid until it is released with release()
+   * @param reader_id a reader subscribed with subscribe_group()
+   * @return the claimed element or nullptr when there is no unclaimed element
+   */
+  [[gnu::hot, nodiscard]] value_type const* try_claim(size_t reader_id) noexcept
   {
-    while (_subscribe_lock.exchange(true))
+    if (_is_evicted(reader_id))
     {
-      // wait for the lock
+      return nullptr;
     }
 
-    _reader_cache[reader_id].reset();
-    _read_idx[reader_id].store(std::numeric_limits<size_t>::max(), std::memory_order_release);
-    _subscribe_lock.store(false);
+    ReaderCache& reader_cache = _reader_cache[reader_id];
+    std::atomic<size_t>& group_claim_idx = _groups[reader_cache.group_id].claim_idx;
+    size_t claim_idx = group_claim_idx.load(std::memory_order_relaxed);
+
+    // The read index of the member is never above the next index it claims, so the producer can
+    // not overwrite the claimed element
+    do
+    {
+      // the cached write index can be behind the claim cursor advanced by the other members
+      if (claim_idx >= reader_cache.write_idx_cache)
+      {
+        reader_cache.write_idx_cache = _write_idx.load(std::memory_order_acquire);
+        if (claim_idx >= reader_cache.write_idx_cache)
+        {
+          // Nothing to claim, publish our position so that an idle member does not hold back the
+          // producer
+          if (reader_cache.read_local_idx != claim_idx)
+          {
+            reader_cache.read_local_idx = claim_idx;
+            _commit_read_idx(reader_id, claim_idx);
+          }
+
+          _count(reader_cache.empty_polls, 1);
+          return nullptr;
+        }
+      }
+    } while (!group_claim_idx.compare_exchange_weak(claim_idx, claim_idx + 1, std::memory_order_relaxed));
+
+    reader_cache.claimed_idx = claim_idx;
+    return reinterpret_cast<value_type const*>(&_slots[claim_idx & _capacity_minus_one]);
   }
 
-private:
-  static_assert(std::is_nothrow_destructible<value_type>::value, "T must be nothrow destructible");
-  static_assert(MAX_READERS != 0, "MAX_READERS can not be zero");
+  /**
+   * Releases the element returned by the last try_claim()
+   */
+  [[gnu::hot]] void release(size_t reader_id) noexcept
+  {
+    _advance(reader_id, _reader_cache[reader_id].claimed_idx + 1);
+  }
 
-  static constexpr size_t CACHE_LINE_SIZE{128u};
+  [[nodiscard]] size_t capacity() const noexcept { return _capacity; }
 
-  static constexpr size_t PADDING =
-    (CACHE_LINE_SIZE - 1) / sizeof(value_type) + 1; /** How many T can we fit in a cache line **/
+  /**
+   * @return the sequence number of the element front() returns, i.e. its position in the stream
+   * of the producer starting from zero
+   */
+  [[nodiscard]] size_t sequence(size_t reader_id) const noexcept { return _reader_cache[reader_id].read_local_idx; }
 
-  struct ReaderCache
+  /**
+   * @return a snapshot of the counters of the producer, it can be called from any thread
+   */
+  [[nodiscard]] ProducerStats producer_stats() const noexcept
   {
-    void set(size_t v) noexcept
+    static_assert(TELEMETRY == Telemetry::Enabled, "producer_stats requires Telemetry::Enabled");
+
+    ProducerStats stats;
+    stats.written = _producer_counters.written.load(std::memory_order_relaxed);
+    stats.full = _producer_counters.full.load(std::memory_order_relaxed);
+    stats.min_read_idx_reloads = _producer_counters.min_read_idx_reloads.load(std::memory_order_relaxed);
+    stats.max_depth = _producer_counters.max_depth.load(std::memory_order_relaxed);
+
+    size_t const write_idx = _write_idx.load(std::memory_order_acquire);
+    _for_each_active_reader(
+      [this, write_idx, &stats](size_t reader_id)
+      { stats.depth = std::max(stats.depth, _reader_lag(reader_id, write_idx)); });
+
+    return stats;
+  }
+
+  /**
+   * @return a snapshot of the counters of the reader, it can be called from any thread
+   */
+  [[nodiscard]] ReaderStats reader_stats(size_t reader_id) const noexcept
+  {
+    static_assert(TELEMETRY == Telemetry::Enabled, "reader_stats requires Telemetry::Enabled");
+
+    ReaderStats stats;
+    stats.lag = _reader_lag(reader_id, _write_idx.load(std::memory_order_acquire));
+    stats.empty_polls = _reader_cache[reader_id].empty_polls.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+  [[nodiscard]] size_t max_readers() const noexcept { return _max_readers; }
+
+  /**
+   * Sets the lag of the readers the producer evicts. When the queue is full, instead of waiting, the
+   * producer evicts the readers lagging more than max_reader_lag elements behind it. From then on
+   * front() returns nullptr and the reader has to unsubscribe(), a reader must therefore check
+   * evicted() each time front() returns nullptr. Only available with Eviction::Enabled.
+   *
+   * An element returned by front() before the eviction can be overwritten while it is read, readers
+   * that can be evicted should check evicted() after using the element.
+   * As readers commit their index in batches, max_reader_lag should leave room for a batch.
+   * It must be set before the queue is used.
+   * @param max_reader_lag max lag in elements, it must be lower than the capacity
+   */
+  void set_max_reader_lag(size_t max_reader_lag)
+  {
+    static_assert(EVICTION == Eviction::Enabled, "set_max_reader_lag requires Eviction::Enabled");
+
+    if (max_reader_lag >= _capacity)
     {
-      read_local_idx = v;
-      write_idx_cache = v;
+      throw std::runtime_error{"max reader lag must be lower than the capacity"};
     }
 
-    void reset() noexcept { set(std::numeric_limits<size_t>::max()); }
+    _max_reader_lag = max_reader_lag;
+  }
 
-    alignas(CACHE_LINE_SIZE) size_t read_local_idx{std::numeric_limits<size_t>::max()};
+  /**
+   * @return true if the producer evicted the reader, always false with Eviction::Disabled
+   */
+  [[nodiscard]] bool evicted(size_t reader_id) const noexcept
+  {
+    if constexpr (EVICTION == Eviction::Enabled)
+    {
+      // order the reads of the last element before the check, see _evict_lagging_readers()
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return _read_idx[reader_id].load(std::memory_order_relaxed) == EVICTED_READER;
+    }
+    else
+    {
+      (void)reader_id;
+      return false;
+    }
+  }
+
+  /**
+   * Subscribes a reader. Subscribing is lock-free and can happen while the producer and the other
+   * readers are running.
+   * @param from the last element written or the oldest element still in the queue
+   * @return the reader id
+   */
+  [[nodiscard]] size_t subscribe(SubscribeFrom from = SubscribeFrom::Latest)
+  {
+    size_t const index = _claim_reader();
+
+    if (index == _max_readers)
+    {
+      throw std::runtime_error{"Max consumers reached"};
+    }
+
+    size_t const write_idx = _write_idx.load(std::memory_order_acquire);
+    size_t read_idx;
+
+    if (from == SubscribeFrom::Latest)
+    {
+      read_idx = (write_idx == 0) ? 0 : write_idx - 1;
+    }
+    else
+    {
+      read_idx = (write_idx > _capacity) ? write_idx - _capacity : 0;
+    }
+
+    _reader_cache[index].set(_join(index, read_idx));
+    return index;
+  }
+
+  /**
+   * Subscribes a reader starting from the element with the given sequence number. When that
+   * element is no longer in the queue the reader starts from the oldest element still in it, which
+   * sequence() reports.
+   * @param sequence the sequence number, it must not be greater than the next sequence number to
+   * be written
+   * @return the reader id
+   */
+  [[nodiscard]] size_t subscribe_at(size_t sequence)
+  {
+    size_t const index = _claim_reader();
+
+    if (index == _max_readers)
+    {
+      throw std::runtime_error{"Max consumers reached"};
+    }
+
+    size_t const write_idx = _write_idx.load(std::memory_order_acquire);
+
+    if (sequence > write_idx)
+    {
+      _release_reader(index);
+      throw std::runtime_error{"Invalid sequence"};
+    }
+
+    size_t const oldest_idx = (write_idx > _capacity) ? write_idx - _capacity : 0;
+
+    _reader_cache[index].set(_join(index, std::max(sequence, oldest_idx)));
+    return index;
+  }
+
+  /**
+   * Subscribes a reader as a member of a consumer group. The members of a group consume the
+   * elements with try_claim() and release() and each element is claimed by a single member.
+   * The first member of a group starts from the same position as subscribe(), unless the group
+   * already claimed it, the following members join at the current claim cursor of the group.
+   * @param group_id the consumer group, it must be lower than max_readers()
+   * @return the reader id of the member
+   */
+  [[nodiscard]] size_t subscribe_group(size_t group_id)
+  {
+    static_assert(OVERFLOW_POLICY == OverflowPolicy::Block, "consumer groups require OverflowPolicy::Block");
+
+    if (group_id >= _max_readers)
+    {
+      throw std::runtime_error{"Invalid consumer group"};
+    }
+
+    size_t const index = _claim_reader();
+
+    if (index == _max_readers)
+    {
+      throw std::runtime_error{"Max consumers reached"};
+    }
+
+    ConsumerGroup& group = _groups[group_id];
+    size_t read_idx;
+
+    if (group.members.fetch_add(1, std::memory_order_relaxed) == 0)
+    {
+      size_t const write_idx = _write_idx.load(std::memory_order_acquire);
+      read_idx = (write_idx == 0) ? 0 : write_idx - 1;
+    }
+    else
+    {
+      // the other members never hold an element below the claim cursor without holding back the
+      // producer themselves, so it is safe to start from it
+      read_idx = group.claim_idx.load(std::memory_order_relaxed);
+    }
+
+    read_idx = _join(index, read_idx);
+
+    // move the claim cursor up to the read index, so that the member never claims an element
+    // below it
+    size_t claim_idx = group.claim_idx.load(std::memory_order_relaxed);
+    while ((claim_idx < read_idx) &&
+           !group.claim_idx.compare_exchange_weak(claim_idx, read_idx, std::memory_order_relaxed))
+    {
+      // claim_idx was reloaded
+    }
+
+    _reader_cache[index].set(read_idx);
+    _reader_cache[index].group_id = group_id;
+    return index;
+  }
+
+  void unsubscribe(size_t reader_id) noexcept
+  {
+    if (_reader_cache[reader_id].group_id != NO_GROUP)
+    {
+      _groups[_reader_cache[reader_id].group_id].members.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    _reader_cache[reader_id].reset();
+    _read_idx[reader_id].store(std::numeric_limits<size_t>::max(), std::memory_order_release);
+    _release_reader(reader_id);
+  }
+
+private:
+  static_assert(std::is_nothrow_destructible<value_type>::value, "T must be nothrow destructible");
+  static_assert(MAX_READERS != 0, "MAX_READERS can not be zero");
+  static_assert((EVICTION == Eviction::Disabled) || (OVERFLOW_POLICY == OverflowPolicy::Block),
+                "Eviction::Enabled requires OverflowPolicy::Block");
+  static_assert((OVERFLOW_POLICY == OverflowPolicy::Block) || std::is_trivially_copyable_v<value_type>,
+                "OverflowPolicy::Overwrite requires a trivially copyable T");
+  static_assert((PUBLISH_POLICY == PublishPolicy::WriteIndex) || (OVERFLOW_POLICY == OverflowPolicy::Block),
+                "PublishPolicy::SlotSequence requires OverflowPolicy::Block");
+
+  using sequence_allocator_type =
+    typename std::allocator_traits<Allocator>::template rebind_alloc<std::atomic<size_t>>;
+
+  static constexpr size_t CACHE_LINE_SIZE{128u};
+
+  /** The bitmap of the subscribed readers uses a bit per reader **/
+  static constexpr size_t ACTIVE_READER_WORDS = (MAX_READERS == DYNAMIC_READERS) ? 0 : (MAX_READERS + 63u) / 64u;
+
+  static constexpr bool HAS_SLOT_SEQUENCES =
+    (OVERFLOW_POLICY == OverflowPolicy::Overwrite) || (PUBLISH_POLICY == PublishPolicy::SlotSequence);
+
+  /** How many slot sequences front() scans at most with PublishPolicy::SlotSequence **/
+  static constexpr size_t SEQUENCES_PER_SCAN = CACHE_LINE_SIZE / sizeof(std::atomic<size_t>);
+
+  static constexpr size_t PADDING =
+    (CACHE_LINE_SIZE - 1) / sizeof(value_type) + 1; /** How many T can we fit in a cache line **/
+
+  static constexpr size_t NO_GROUP = std::numeric_limits<size_t>::max();
+  static constexpr size_t NO_MAX_READER_LAG = std::numeric_limits<size_t>::max();
+
+  /** The read index of an evicted reader, unlike a free slot it can not be subscribed **/
+  static constexpr size_t EVICTED_READER = ReadIdxScan::NO_READ_IDX;
+
+  /** A counter with Telemetry::Disabled, see _count() **/
+  struct NoCounter
+  {
+  };
+
+  using counter_type = std::conditional_t<TELEMETRY == Telemetry::Enabled, std::atomic<size_t>, NoCounter>;
+
+  struct ReaderCache
+  {
+    void set(size_t v) noexcept
+    {
+      read_local_idx = v;
+      write_idx_cache = v;
+      lost_count = 0;
+
+      if constexpr (TELEMETRY == Telemetry::Enabled)
+      {
+        empty_polls.store(0, std::memory_order_relaxed);
+      }
+    }
+
+    void reset() noexcept
+    {
+      set(std::numeric_limits<size_t>::max());
+      group_id = NO_GROUP;
+    }
+
+    alignas(CACHE_LINE_SIZE) size_t read_local_idx{std::numeric_limits<size_t>::max()};
     size_t write_idx_cache{std::numeric_limits<size_t>::max()};
+    size_t group_id{NO_GROUP};
+    size_t claimed_idx{0};
+    size_t lost_count{0};
+
+    /** Written by the reader, read by any thread, see Telemetry **/
+    counter_type empty_polls{};
   };
 
+  /** Written by the producer, read by any thread, see Telemetry **/
+  struct alignas(CACHE_LINE_SIZE) ProducerCounters
+  {
+    std::atomic<size_t> written{0};
+    std::atomic<size_t> full{0};
+    std::atomic<size_t> min_read_idx_reloads{0};
+    std::atomic<size_t> max_depth{0};
+  };
+
+  /** The counters with Telemetry::Disabled, no cache line and never written **/
+  struct NoProducerCounters
+  {
+    NoCounter written;
+    NoCounter full;
+    NoCounter min_read_idx_reloads;
+    NoCounter max_depth;
+  };
+
+  using producer_counters_type =
+    std::conditional_t<TELEMETRY == Telemetry::Enabled, ProducerCounters, NoProducerCounters>;
+
+  /** A read index on its own cache line **/
+  struct alignas(CACHE_LINE_SIZE) PaddedReadIdx : std::atomic<size_t>
+  {
+  };
+
+  using read_idx_type =
+    std::conditional_t<READ_INDEX_LAYOUT == ReadIndexLayout::Padded, PaddedReadIdx, std::atomic<size_t>>;
+
+  /** The reader tables are allocated at runtime with DYNAMIC_READERS **/
+  template <typename U, size_t N = MAX_READERS>
+  using reader_table_type =
+    std::conditional_t<MAX_READERS == DYNAMIC_READERS, std::unique_ptr<U[]>, std::array<U, N>>;
+
+  struct ConsumerGroup
+  {
+    /** Shared by the members **/
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> claim_idx{0};
+
+    std::atomic<size_t> members{0};
+  };
+
+private:
+  /**
+   * Shared by the public constructors, max_readers is MAX_READERS unless it is DYNAMIC_READERS
+   */
+  SPBroadcastQueue(size_t capacity, size_t reader_batch_size, Allocator const& allocator, size_t max_readers)
+    : _capacity(std::max(size_t{16}, next_power_of_two(capacity))),
+      _capacity_minus_one(_capacity - 1),
+      _items_per_batch_minus_one((_capacity / reader_batch_size) - 1),
+      _max_readers(max_readers),
+      _active_reader_words((max_readers + 63) / 64),
+      _allocator(allocator)
+  {
+    if (!is_power_of_two(_items_per_batch_minus_one + 1))
+    {
+      throw std::runtime_error{"items per batch must be power of 2"};
+    }
+
+    if (_max_readers == 0)
+    {
+      throw std::runtime_error{"max readers can not be zero"};
+    }
+
+    if constexpr (MAX_READERS == DYNAMIC_READERS)
+    {
+      _read_idx = std::make_unique<read_idx_type[]>(_max_readers);
+      _reader_cache = std::make_unique<ReaderCache[]>(_max_readers);
+      _groups = std::make_unique<ConsumerGroup[]>(_max_readers);
+      _active_readers = std::make_unique<std::atomic<uint64_t>[]>(_active_reader_words);
+    }
+
+    // we add some padding to the start and end of the buffer to protect it from false sharing
+    // --- padding --- | --- slots* ---- | --- padding --- |
+    _buffer = std::allocator_traits<Allocator>::allocate(_allocator, _capacity + (2u * PADDING));
+    _slots = _buffer + PADDING;
+
+    if constexpr (HAS_SLOT_SEQUENCES)
+    {
+      sequence_allocator_type sequence_allocator{_allocator};
+      _sequences = std::allocator_traits<sequence_allocator_type>::allocate(sequence_allocator, _capacity);
+
+      for (size_t i = 0; i < _capacity; ++i)
+      {
+        ::new (static_cast<void*>(&_sequences[i])) std::atomic<size_t>{0};
+      }
+    }
+
+    for (size_t i = 0; i < _max_readers; ++i)
+    {
+      _reader_cache[i].reset();
+    }
+
+    for (size_t i = 0; i < _max_readers; ++i)
+    {
+      _read_idx[i].store(std::numeric_limits<size_t>::max());
+    }
+
+    for (size_t i = 0; i < _active_reader_words; ++i)
+    {
+      _active_readers[i].store(0);
+    }
+
+    _write_idx.store(0);
+  }
+
+  /**
+   * Checks if n elements can be written, reloading the read indexes of the readers only when the
+   * cached min read index does not leave enough space
+   */
+  [[gnu::always_inline, nodiscard]] bool _has_space(size_t write_idx, size_t n) noexcept
+  {
+    if constexpr (OVERFLOW_POLICY == OverflowPolicy::Overwrite)
+    {
+      // the producer never waits for the readers
+      return true;
+    }
+
+    if (_is_full(write_idx, n))
+    {
+      _reload_min_read_idx(write_idx);
+
+      if (_is_full(write_idx, n))
+      {
+        if constexpr (EVICTION == Eviction::Enabled)
+        {
+          if ((_max_reader_lag == NO_MAX_READER_LAG) || !_evict_lagging_readers(write_idx))
+          {
+            return false;
+          }
+
+          _reload_min_read_idx(write_idx);
+          return !_is_full(write_idx, n);
+        }
+        else
+        {
+          return false;
+        }
+      }
+    }
+
+    return true;
+  }
+
+  [[gnu::always_inline]] void _reload_min_read_idx(size_t write_idx) noexcept
+  {
+    _min_read_idx_cache = _load_min_read_idx();
+
+    if constexpr (TELEMETRY == Telemetry::Enabled)
+    {
+      _count(_producer_counters.min_read_idx_reloads, 1);
+
+      if (_min_read_idx_cache < EVICTED_READER)
+      {
+        size_t const depth = write_idx - _min_read_idx_cache;
+        if (depth > _producer_counters.max_depth.load(std::memory_order_relaxed))
+        {
+          _producer_counters.max_depth.store(depth, std::memory_order_relaxed);
+        }
+      }
+    }
+  }
+
+  /**
+   * Adds n to a counter only the calling thread writes. A plain load and store is enough, unlike
+   * an atomic read-modify-write it does not lock the cache line
+   */
+  template <typename Counter>
+  [[gnu::always_inline]] static void _count(Counter& counter, size_t n) noexcept
+  {
+    if constexpr (TELEMETRY == Telemetry::Enabled)
+    {
+      counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    else
+    {
+      (void)counter;
+      (void)n;
+    }
+  }
+
+  /**
+   * Checks against the cached min read index, free and evicted reader slots are above any read index
+   */
+  [[gnu::always_inline, nodiscard]] bool _is_full(size_t write_idx, size_t n) const noexcept
+  {
+    return (_min_read_idx_cache >= EVICTED_READER) || ((write_idx + n - _min_read_idx_cache) > _capacity);
+  }
+
+  /**
+   * Reloads the min read index of the subscribed readers. The scan is published to the joining
+   * readers, see ReadIdxScan
+   */
+  [[nodiscard]] size_t _load_min_read_idx() noexcept
+  {
+    return _read_idx_scan.scan(
+      [this]()
+      {
+        if constexpr (MAX_READERS == 1)
+        {
+          return _read_idx[0].load(std::memory_order_relaxed);
+        }
+        else
+        {
+          // independent relaxed loads, ReadIdxScan orders them all with a single acquire fence
+          size_t min_read_idx = std::numeric_limits<size_t>::max();
+          _for_each_active_reader(
+            [this, &min_read_idx](size_t reader_id)
+            { min_read_idx = std::min(min_read_idx, _read_idx[reader_id].load(std::memory_order_relaxed)); });
+
+          return min_read_idx;
+        }
+      });
+  }
+
+  /**
+   * Publishes the read index of a joining reader, moving it up to the min read index the producer
+   * last loaded, see ReadIdxScan
+   * @return the read index the reader starts from
+   */
+  [[nodiscard]] size_t _join(size_t reader_id, size_t read_idx) noexcept
+  {
+    return _read_idx_scan.join(_read_idx[reader_id], read_idx, _write_idx);
+  }
+
+  /**
+   * Evicts the readers lagging more than _max_reader_lag behind write_idx
+   * @return true if any reader was evicted
+   */
+  [[gnu::cold]] bool _evict_lagging_readers(size_t write_idx) noexcept
+  {
+    bool any_evicted = false;
+
+    _for_each_active_reader(
+      [this, write_idx, &any_evicted](size_t reader_id)
+      {
+        size_t read_idx = _read_idx[reader_id].load(std::memory_order_acquire);
+
+        // the compare and swap fails if the reader moved in the meantime
+        if ((read_idx < EVICTED_READER) && ((write_idx - read_idx) > _max_reader_lag) &&
+            _read_idx[reader_id].compare_exchange_strong(read_idx, EVICTED_READER, std::memory_order_relaxed))
+        {
+          any_evicted = true;
+        }
+      });
+
+    if (any_evicted)
+    {
+      // An evicted reader can still be reading an element the producer is about to overwrite. Any
+      // reader that sees a write made after the fence, and then checks evicted(), sees the eviction
+      std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    return any_evicted;
+  }
+
+  /**
+   * Calls func with the id of each subscribed reader
+   */
+  template <typename TFunc>
+  [[gnu::always_inline]] void _for_each_active_reader(TFunc func) const
+  {
+    for (size_t word_idx = 0; word_idx < _active_reader_words; ++word_idx)
+    {
+      uint64_t active = _active_readers[word_idx].load(std::memory_order_acquire);
+
+      while (active != 0)
+      {
+        func((word_idx * 64u) + count_trailing_zeros(active));
+        active &= active - 1u;
+      }
+    }
+  }
+
+  /**
+   * Claims the slot of a reader that is not subscribed, the producer scans it from then on
+   * @return the reader id or max_readers() if all the slots are taken
+   */
+  [[nodiscard]] size_t _claim_reader() noexcept
+  {
+    for (size_t word_idx = 0; word_idx < _active_reader_words; ++word_idx)
+    {
+      uint64_t active = _active_readers[word_idx].load(std::memory_order_relaxed);
+
+      while (~active != 0)
+      {
+        size_t const reader_id = (word_idx * 64u) + count_trailing_zeros(~active);
+
+        if (reader_id >= _max_readers)
+        {
+          break;
+        }
+
+        // the compare and swap reloads active if another reader claimed a slot in the meantime
+        if (_active_readers[word_idx].compare_exchange_weak(active, active | (uint64_t{1} << (reader_id % 64u)),
+                                                             std::memory_order_acquire, std::memory_order_relaxed))
+        {
+          return reader_id;
+        }
+      }
+    }
+
+    return _max_readers;
+  }
+
+  /**
+   * @return the elements the reader did not commit as read yet, zero if it is not subscribed
+   */
+  [[nodiscard]] size_t _reader_lag(size_t reader_id, size_t write_idx) const noexcept
+  {
+    size_t const read_idx = _read_idx[reader_id].load(std::memory_order_relaxed);
+    return ((read_idx < EVICTED_READER) && (read_idx < write_idx)) ? write_idx - read_idx : 0;
+  }
+
+  /**
+   * Frees the slot of the reader, it can be claimed again from now on
+   */
+  void _release_reader(size_t reader_id) noexcept
+  {
+    _active_readers[reader_id / 64u].fetch_and(~(uint64_t{1} << (reader_id % 64u)), std::memory_order_release);
+  }
+
+  [[gnu::always_inline, nodiscard]] bool _is_evicted(size_t reader_id) const noexcept
+  {
+    if constexpr (EVICTION == Eviction::Enabled)
+    {
+      return _read_idx[reader_id].load(std::memory_order_relaxed) == EVICTED_READER;
+    }
+    else
+    {
+      (void)reader_id;
+      return false;
+    }
+  }
+
+  [[nodiscard]] bool _has_data_or_evicted(size_t reader_id) noexcept
+  {
+    return (front(reader_id) != nullptr) || _is_evicted(reader_id);
+  }
+
+  /**
+   * Publishes the read index of the reader, unless the producer evicted it
+   */
+  [[gnu::always_inline]] void _commit_read_idx(size_t reader_id, size_t read_idx) noexcept
+  {
+    if constexpr (EVICTION == Eviction::Disabled)
+    {
+      _read_idx[reader_id].store(read_idx, std::memory_order_release);
+    }
+    else
+    {
+      size_t prev_read_idx = _read_idx[reader_id].load(std::memory_order_relaxed);
+
+      // the compare and swap fails if the producer evicted the reader in the meantime
+      if (prev_read_idx != EVICTED_READER)
+      {
+        _read_idx[reader_id].compare_exchange_strong(prev_read_idx, read_idx, std::memory_order_release,
+                                                     std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * Moves the reader to read_local_idx, committing the read index when a batch boundary is crossed
+   */
+  [[gnu::always_inline]] void _advance(size_t reader_id, size_t read_local_idx) noexcept
+  {
+    size_t const prev_read_local_idx = _reader_cache[reader_id].read_local_idx;
+    _reader_cache[reader_id].read_local_idx = read_local_idx;
+
+    if ((read_local_idx & ~_items_per_batch_minus_one) != (prev_read_local_idx & ~_items_per_batch_minus_one))
+    {
+      // a batch boundary was crossed
+      _commit_read_idx(reader_id, read_local_idx);
+    }
+  }
+
+  /**
+   * Returns the slot for write_idx, destroying the element it holds from the previous round
+   */
+  [[gnu::always_inline, nodiscard]] value_type* _prepare_slot(size_t write_idx) noexcept
+  {
+    value_type* slot = &_slots[write_idx & _capacity_minus_one];
+
+    if constexpr (OVERFLOW_POLICY == OverflowPolicy::Overwrite)
+    {
+      // an odd sequence marks the slot as being written, the fence orders it before the writes
+      // of the element
+      _sequences[write_idx & _capacity_minus_one].store(2u * write_idx + 1u, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    if constexpr (!std::is_trivially_destructible_v<value_type>)
+    {
+      if (write_idx >= _capacity)
+      {
+        // do not call the destructor until we have wrapped around at least once
+        slot->~value_type();
+      }
+    }
+
+    return slot;
+  }
+
+  /**
+   * Marks the element of write_idx as written
+   */
+  [[gnu::always_inline]] void _publish_slot(size_t write_idx) noexcept
+  {
+    if constexpr (HAS_SLOT_SEQUENCES)
+    {
+      _sequences[write_idx & _capacity_minus_one].store(2u * write_idx + 2u, std::memory_order_release);
+    }
+  }
+
+  /**
+   * @return true if the slot still holds the element of idx
+   */
+  [[gnu::always_inline, nodiscard]] bool _is_published(size_t idx, std::memory_order order) const noexcept
+  {
+    return _sequences[idx & _capacity_minus_one].load(order) == 2u * idx + 2u;
+  }
+
+  /**
+   * Scans forward over the consecutive published elements starting at idx, at most a cache line of
+   * sequences so that a long backlog does not delay the first element
+   * @return the index past the last published element found
+   */
+  [[gnu::always_inline, nodiscard]] size_t _published_end(size_t idx) const noexcept
+  {
+    size_t const scan_end = idx + std::min(SEQUENCES_PER_SCAN, _capacity);
+
+    while ((idx != scan_end) && _is_published(idx, std::memory_order_relaxed))
+    {
+      ++idx;
+    }
+
+    return idx;
+  }
+
+  /**
+   * Moves a lapped reader to the oldest element still in the queue and counts the lost elements
+   */
+  [[gnu::cold]] void _resync(size_t reader_id) noexcept
+  {
+    ReaderCache& reader_cache = _reader_cache[reader_id];
+
+    do
+    {
+      reader_cache.write_idx_cache = _write_idx.load(std::memory_order_acquire);
+
+      // the slot of the oldest element can also be in the middle of being overwritten, in which
+      // case the next iteration skips it
+      size_t const oldest_idx = std::max(reader_cache.write_idx_cache - _capacity, reader_cache.read_local_idx + 1);
+      reader_cache.lost_count += oldest_idx - reader_cache.read_local_idx;
+      reader_cache.read_local_idx = oldest_idx;
+    } while (!_is_published(reader_cache.read_local_idx, std::memory_order_acquire));
+  }
+
 private:
   /** Members **/
   size_t _capacity;
   size_t _capacity_minus_one;
   size_t _items_per_batch_minus_one;
+  size_t _max_readers;
+  size_t _active_reader_words;
+  size_t _max_reader_lag{NO_MAX_READER_LAG};
   value_type* _slots = nullptr;
   value_type* _buffer = nullptr;
-  std::atomic<bool> _subscribe_lock;
   Allocator _allocator;
+  WaitStrategy _wait_strategy;
+  std::atomic<size_t>* _sequences = nullptr;
+  producer_counters_type _producer_counters; /** On its own cache line with Telemetry::Enabled **/
 
   alignas(CACHE_LINE_SIZE) std::atomic<size_t> _write_idx = {0};
   alignas(CACHE_LINE_SIZE) size_t _min_read_idx_cache = std::numeric_limits<size_t>::max();
-  alignas(CACHE_LINE_SIZE) std::array<std::atomic<size_t>, MAX_READERS> _read_idx;
-  alignas(CACHE_LINE_SIZE) std::array<ReaderCache, MAX_READERS> _reader_cache;
+  alignas(CACHE_LINE_SIZE) ReadIdxScan _read_idx_scan;
+  alignas(CACHE_LINE_SIZE) reader_table_type<std::atomic<uint64_t>, ACTIVE_READER_WORDS> _active_readers;
+  alignas(CACHE_LINE_SIZE) reader_table_type<read_idx_type> _read_idx;
+  alignas(CACHE_LINE_SIZE) reader_table_type<ReaderCache> _reader_cache;
+  alignas(CACHE_LINE_SIZE) reader_table_type<ConsumerGroup> _groups;
 };
 } // namespace lockfree_queues
\ No newline at end of file
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include "lockfree_queues/utilities.h"
+
+namespace lockfree_queues
+{
+
+/***
+ * A bounded single-producer single-consumer queue.
+ *
+ * It follows the same design as SPBroadcastQueue but is specialised for exactly one consumer.
+ * There is no subscription and no reader bookkeeping: the consumer can start consuming right
+ * away, and the producer only tracks a single read index.
+ *
+ * The producer is responsible for creating and destroying the objects in the queue. Elements are
+ * destroyed when their slot is reused or when the queue is destroyed.
+ *
+ * Both the producer and the consumer cache the indexes locally, loading them only when they can't
+ * produce or consume anymore. The consumer updates its index after consuming multiple messages,
+ * rather than updating it each time. By default, the queue is split into four batches.
+ *
+ * @tparam T Type of the element
+ * @tparam Allocator An allocator used to allocate memory
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+class SPSCQueue
+{
+public:
+  using value_type = T;
+
+  /**
+   * Constructor
+   * @param capacity Max element capacity
+   * @param reader_batch_size The reader commits its reads to the producer in batches to increase throughput
+   * @param allocator memory allocator
+   */
+  explicit SPSCQueue(size_t capacity, size_t reader_batch_size = 4, Allocator const& allocator = Allocator())
+    : _capacity(std::max(size_t{16}, next_power_of_two(capacity))),
+      _capacity_minus_one(_capacity - 1),
+      _items_per_batch_minus_one((_capacity / reader_batch_size) - 1),
+      _allocator(allocator)
+  {
+    if (!is_power_of_two(_items_per_batch_minus_one + 1))
+    {
+      throw std::runtime_error{"items per batch must be power of 2"};
+    }
+
+    // we add some padding to the start and end of the buffer to protect it from false sharing
+    // --- padding --- | --- slots* ---- | --- padding --- |
+    _buffer = std::allocator_traits<Allocator>::allocate(_allocator, _capacity + (2u * PADDING));
+    _slots = _buffer + PADDING;
+  }
+
+  /**
+   * Destructor is expected to run by the writer
+   */
+  ~SPSCQueue()
+  {
+    size_t const write_idx = _write_idx.load(std::memory_order_relaxed);
+    size_t const n = (write_idx >= _capacity) ? _capacity : write_idx;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+      _slots[i].~T();
+    }
+
+    std::allocator_traits<Allocator>::deallocate(_allocator, _buffer, _capacity + (2u * PADDING));
+  }
+
+  /** Deleted **/
+  SPSCQueue(SPSCQueue const&) = delete;
+  SPSCQueue& operator=(SPSCQueue const&) = delete;
+
+  template <typename... Args>
+  [[gnu::always_inline, gnu::hot]] void emplace(Args&&... args)
+  {
+    while (!try_emplace(std::forward<Args>(args)...))
+    {
+      // retry
+    }
+  }
+
+  template <typename... Args>
+  [[gnu::always_inline, gnu::hot, nodiscard]] bool try_emplace(Args&&... args)
+  {
+    value_type* slot = try_reserve();
+
+    if (!slot)
+    {
+      return false;
+    }
+
+    ::new (static_cast<void*>(slot)) value_type{std::forward<Args>(args)...};
+    commit();
+
+    return true;
+  }
+
+  /**
+   * Reserves the next slot for writing without publishing it.
+   * A value_type must be constructed in the returned storage and then published with commit()
+   * @return pointer to the uninitialised storage of the next slot or nullptr when the queue is full
+   */
+  [[gnu::always_inline, gnu::hot, nodiscard]] value_type* try_reserve() noexcept
+  {
+    size_t const write_idx = _write_idx.load(std::memory_order_relaxed);
+
+    if ((write_idx - _read_idx_cache) == _capacity)
+    {
+      _read_idx_cache = _read_idx.load(std::memory_order_acquire);
+
+      if ((write_idx - _read_idx_cache) == _capacity)
+      {
+        return nullptr;
+      }
+    }
+
+    value_type* slot = &_slots[write_idx & _capacity_minus_one];
+
+    if constexpr (!std::is_trivially_destructible_v<value_type>)
+    {
+      if (write_idx >= _capacity)
+      {
+        // do not call the destructor until we have wrapped around at least once
+        slot->~value_type();
+      }
+    }
+
+    return slot;
+  }
+
+  /**
+   * Publishes the element previously constructed in the slot returned by try_reserve()
+   */
+  [[gnu::always_inline, gnu::hot]] void commit() noexcept
+  {
+    _write_idx.store(_write_idx.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  [[gnu::always_inline, gnu::hot, nodiscard]] value_type const* front() noexcept
+  {
+    if (_read_local_idx == _write_idx_cache)
+    {
+      _write_idx_cache = _write_idx.load(std::memory_order_acquire);
+      if (_read_local_idx == _write_idx_cache)
+      {
+        return nullptr;
+      }
+    }
+
+    return &_slots[_read_local_idx & _capacity_minus_one];
+  }
+
+  [[gnu::always_inline, gnu::hot]] void pop() noexcept
+  {
+    _read_local_idx += 1;
+
+    if ((_read_local_idx & _items_per_batch_minus_one) == 0)
+    {
+      _read_idx.store(_read_local_idx, std::memory_order_release);
+    }
+  }
+
+  [[nodiscard]] size_t capacity() const noexcept { return _capacity; }
+
+private:
+  static_assert(std::is_nothrow_destructible<value_type>::value, "T must be nothrow destructible");
+
+  static constexpr size_t CACHE_LINE_SIZE{128u};
+
+  static constexpr size_t PADDING =
+    (CACHE_LINE_SIZE - 1) / sizeof(value_type) + 1; /** How many T can we fit in a cache line **/
+
+private:
+  /** Members **/
+  size_t _capacity;
+  size_t _capacity_minus_one;
+  size_t _items_per_batch_minus_one;
+  value_type* _slots = nullptr;
+  value_type* _buffer = nullptr;
+  Allocator _allocator;
+
+  /** Written by the producer **/
+  alignas(CACHE_LINE_SIZE) std::atomic<size_t> _write_idx = {0};
+
+  /** Producer local **/
+  alignas(CACHE_LINE_SIZE) size_t _read_idx_cache{0};
+
+  /** Written by the consumer **/
+  alignas(CACHE_LINE_SIZE) std::atomic<size_t> _read_idx = {0};
+
+  /** Consumer local **/
+  alignas(CACHE_LINE_SIZE) size_t _read_local_idx{0};
+  size_t _write_idx_cache{0};
+};
+} // namespace lockfree_queues
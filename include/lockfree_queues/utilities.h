@@ -1,6 +1,15 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+  #include <intrin.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+  #include <immintrin.h>
+#endif
 
 namespace lockfree_queues
 {
@@ -18,4 +27,44 @@ namespace lockfree_queues
 {
   return (n != 0) && ((n & (n - 1)) == 0);
 }
-} // namespace lockfree_queues
\ No newline at end of file
+
+/**
+ * @return the index of the lowest set bit, v must not be zero
+ */
+[[nodiscard]] inline size_t count_trailing_zeros(uint64_t v) noexcept
+{
+#if defined(_MSC_VER)
+  unsigned long idx;
+  _BitScanForward64(&idx, v);
+  return static_cast<size_t>(idx);
+#else
+  return static_cast<size_t>(__builtin_ctzll(v));
+#endif
+}
+
+/**
+ * @return the number of zero bits above the highest set bit, v must not be zero
+ */
+[[nodiscard]] inline size_t count_leading_zeros(uint64_t v) noexcept
+{
+#if defined(_MSC_VER)
+  unsigned long idx;
+  _BitScanReverse64(&idx, v);
+  return 63u - static_cast<size_t>(idx);
+#else
+  return static_cast<size_t>(__builtin_clzll(v));
+#endif
+}
+
+/**
+ * Hints the cpu that the calling thread is spin waiting
+ */
+inline void cpu_pause() noexcept
+{
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+  _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  __asm__ __volatile__("yield");
+#endif
+}
+} // namespace lockfree_queues
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "lockfree_queues/utilities.h"
+
+#if defined(__linux__)
+  #include <climits>
+  #include <ctime>
+  #include <linux/futex.h>
+  #include <linux/membarrier.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#else
+  #include <condition_variable>
+  #include <mutex>
+#endif
+
+namespace lockfree_queues
+{
+/***
+ * Wait strategies decide what a thread does while it can not make progress, i.e. the producer
+ * while the queue is full or a consumer while the queue is empty.
+ *
+ * A wait strategy provides :
+ *  - wait(attempt) : called repeatedly by the producer while the queue is full, attempt is the
+ *    number of consecutive unsuccessful attempts so far
+ *  - wait_for_data(attempt, has_data) : called repeatedly by a consumer while the queue is empty,
+ *    has_data() checks the queue again and can be used before blocking
+ *  - notify() : called by the producer after publishing new elements
+ */
+
+/**
+ * Keeps retrying without ever giving up the core. Lowest latency, burns a full core while waiting
+ */
+class BusySpinWaitStrategy
+{
+public:
+  [[gnu::always_inline]] void wait(uint32_t) noexcept {}
+
+  template <typename Predicate>
+  [[gnu::always_inline]] void wait_for_data(uint32_t, Predicate const&) noexcept
+  {
+  }
+
+  [[gnu::always_inline]] void notify() noexcept {}
+};
+
+/**
+ * Spins using a cpu pause instruction and then yields the core to other threads
+ * @tparam SPIN_ATTEMPTS attempts before starting to yield
+ */
+template <uint32_t SPIN_ATTEMPTS = 256>
+class BackoffWaitStrategy
+{
+public:
+  void wait(uint32_t attempt) noexcept
+  {
+    if (attempt < SPIN_ATTEMPTS)
+    {
+      cpu_pause();
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  template <typename Predicate>
+  void wait_for_data(uint32_t attempt, Predicate const&) noexcept
+  {
+    wait(attempt);
+  }
+
+  [[gnu::always_inline]] void notify() noexcept {}
+};
+
+/**
+ * Spins, then yields and finally sleeps between attempts. Suitable for low priority threads that
+ * can tolerate the extra latency of waking up
+ * @tparam SPIN_ATTEMPTS attempts before starting to yield
+ * @tparam YIELD_ATTEMPTS attempts before starting to sleep
+ * @tparam SLEEP_DURATION_US sleep duration in microseconds
+ */
+template <uint32_t SPIN_ATTEMPTS = 256, uint32_t YIELD_ATTEMPTS = 256, uint32_t SLEEP_DURATION_US = 50>
+class SleepWaitStrategy
+{
+public:
+  void wait(uint32_t attempt) noexcept
+  {
+    if (attempt < SPIN_ATTEMPTS)
+    {
+      cpu_pause();
+    }
+    else if (attempt < SPIN_ATTEMPTS + YIELD_ATTEMPTS)
+    {
+      std::this_thread::yield();
+    }
+    else
+    {
+      std::this_thread::sleep_for(std::chrono::microseconds{SLEEP_DURATION_US});
+    }
+  }
+
+  template <typename Predicate>
+  void wait_for_data(uint32_t attempt, Predicate const&) noexcept
+  {
+    wait(attempt);
+  }
+
+  [[gnu::always_inline]] void notify() noexcept {}
+};
+
+/**
+ * Consumers spin for a while and then park on a futex until the producer publishes. The producer
+ * only pays for a relaxed load of the sleepers counter after each publish, and only wakes up
+ * consumers when at least one of them is parked. On platforms without futex a condition variable
+ * is used instead.
+ *
+ * The ordering between the publish and the load of the sleepers is paid by the parking consumer
+ * rather than the producer. On Linux, after announcing itself and before checking the queue again,
+ * the consumer issues membarrier(MEMBARRIER_CMD_PRIVATE_EXPEDITED), which runs a full barrier on
+ * every running thread of the process, so either the producer sees the sleeper or the consumer
+ * sees the data and no wake up is lost. Where membarrier is not available, a wake up can be missed
+ * and the consumer then sees the data when its park times out, PARK_TIMEOUT_US bounds the delay.
+ *
+ * The producer never parks while the queue is full as consumers do not notify, it backs off by
+ * yielding instead.
+ *
+ * @tparam SPIN_ATTEMPTS attempts before parking or yielding
+ * @tparam PARK_TIMEOUT_US max time a consumer stays parked in microseconds
+ */
+template <uint32_t SPIN_ATTEMPTS = 256, uint32_t PARK_TIMEOUT_US = 1000>
+class ParkingWaitStrategy
+{
+public:
+  ParkingWaitStrategy() : _has_membarrier(_register_membarrier()) {}
+
+  /** Deleted **/
+  ParkingWaitStrategy(ParkingWaitStrategy const&) = delete;
+  ParkingWaitStrategy& operator=(ParkingWaitStrategy const&) = delete;
+
+  void wait(uint32_t attempt) noexcept
+  {
+    if (attempt < SPIN_ATTEMPTS)
+    {
+      cpu_pause();
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  template <typename Predicate>
+  void wait_for_data(uint32_t attempt, Predicate const& has_data) noexcept
+  {
+    if (attempt < SPIN_ATTEMPTS)
+    {
+      cpu_pause();
+      return;
+    }
+
+    // Announce the sleeper before checking the queue again, any publish after this point bumps
+    // the epoch and either wakes us up or makes the futex wait return immediately
+    _sleepers.fetch_add(1, std::memory_order_seq_cst);
+    uint32_t const epoch = _epoch.load(std::memory_order_seq_cst);
+
+    // orders the announce before the loads of has_data() on this thread, and the publish before the
+    // load of the sleepers on the producer thread
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    _heavy_barrier();
+
+    if (!has_data())
+    {
+      _park(epoch);
+    }
+
+    _sleepers.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  [[gnu::always_inline]] void notify() noexcept
+  {
+    // only stops the compiler from moving the load above the publish, the barrier of the parking
+    // consumer orders them in the cpu, see _heavy_barrier()
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+
+    if (_sleepers.load(std::memory_order_relaxed) != 0)
+    {
+      _wake();
+    }
+  }
+
+private:
+  /**
+   * @return true if the process can use membarrier(MEMBARRIER_CMD_PRIVATE_EXPEDITED)
+   */
+  [[nodiscard]] static bool _register_membarrier() noexcept
+  {
+#if defined(__linux__) && defined(SYS_membarrier)
+    // registration is per process and only needed once
+    static bool const registered =
+      syscall(SYS_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0, 0) == 0;
+    return registered;
+#else
+    return false;
+#endif
+  }
+
+  /**
+   * Runs a full barrier on every running thread of the process, e.g. on the producer between its
+   * publish and its load of the sleepers
+   */
+  void _heavy_barrier() const noexcept
+  {
+#if defined(__linux__) && defined(SYS_membarrier)
+    if (_has_membarrier)
+    {
+      syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0);
+    }
+#endif
+  }
+
+  void _park(uint32_t epoch) noexcept
+  {
+#if defined(__linux__)
+    timespec const timeout{0, static_cast<long>(PARK_TIMEOUT_US) * 1000};
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&_epoch), FUTEX_WAIT_PRIVATE, epoch, &timeout,
+            nullptr, 0);
+#else
+    std::unique_lock<std::mutex> lock{_mutex};
+    _cond.wait_for(lock, std::chrono::microseconds{PARK_TIMEOUT_US},
+                   [this, epoch]() { return _epoch.load(std::memory_order_relaxed) != epoch; });
+#endif
+  }
+
+  [[gnu::noinline, gnu::cold]] void _wake() noexcept
+  {
+    _epoch.fetch_add(1, std::memory_order_release);
+
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&_epoch), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr,
+            nullptr, 0);
+#else
+    {
+      std::lock_guard<std::mutex> lock{_mutex};
+    }
+    _cond.notify_all();
+#endif
+  }
+
+private:
+  static constexpr size_t CACHE_LINE_SIZE{128u};
+  static_assert(PARK_TIMEOUT_US < 1000000u, "PARK_TIMEOUT_US must be less than a second");
+
+  alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> _sleepers{0};
+  std::atomic<uint32_t> _epoch{0};
+  bool _has_membarrier;
+
+#if !defined(__linux__)
+  std::mutex _mutex;
+  std::condition_variable _cond;
+#endif
+};
+} // namespace lockfree_queues
@@ -0,0 +1,89 @@
+#include "doctest/doctest.h"
+
+#include "lockfree_queues/huge_page_allocator.h"
+#include "lockfree_queues/sp_broadcast_queue.h"
+
+#include <cstdint>
+#include <system_error>
+
+TEST_SUITE_BEGIN("HugePageAllocator");
+
+using namespace lockfree_queues;
+
+/***/
+TEST_CASE("huge_page_allocate_deallocate")
+{
+  HugePageAllocator<uint64_t> allocator;
+
+  size_t const n = 300'000;
+  uint64_t* p = allocator.allocate(n);
+  REQUIRE(p);
+
+  // aligned to the huge page size
+  REQUIRE_EQ(reinterpret_cast<uintptr_t>(p) % static_cast<size_t>(HugePageSize::Huge2MB), 0);
+
+  for (size_t i = 0; i < n; ++i)
+  {
+    p[i] = i;
+  }
+
+  for (size_t i = 0; i < n; ++i)
+  {
+    REQUIRE_EQ(p[i], i);
+  }
+
+  allocator.deallocate(p, n);
+}
+
+/***/
+TEST_CASE("huge_page_allocator_rebind")
+{
+  HugePageAllocator<uint64_t> allocator{HugePageSize::Huge2MB, HugePageAllocator<uint64_t>::NO_NUMA_NODE, true};
+  HugePageAllocator<char> rebound{allocator};
+
+  REQUIRE(rebound.prefault());
+  REQUIRE_FALSE(rebound.lock());
+  REQUIRE(allocator == rebound);
+  REQUIRE(allocator != HugePageAllocator<char>{});
+}
+
+/***/
+TEST_CASE("huge_page_allocator_queue")
+{
+  // bound to the NUMA node of the current cpu and prefaulted
+  HugePageAllocator<size_t> allocator{HugePageSize::Huge2MB, HugePageAllocator<size_t>::CURRENT_NUMA_NODE, true};
+  SPBroadcastQueue<size_t, 1, HugePageAllocator<size_t>> q{65536, 4, allocator};
+
+  size_t const rid = q.subscribe();
+
+  for (size_t iter = 0; iter < 3; ++iter)
+  {
+    for (size_t i = 0; i < q.capacity(); ++i)
+    {
+      REQUIRE(q.try_emplace(i));
+    }
+
+    REQUIRE_FALSE(q.try_emplace(0u));
+
+    for (size_t i = 0; i < q.capacity(); ++i)
+    {
+      REQUIRE_EQ(*q.front(rid), i);
+      q.pop(rid);
+    }
+  }
+}
+
+#if defined(__linux__)
+/***/
+TEST_CASE("huge_page_allocator_invalid_numa_node")
+{
+  // node 63 is a valid mask bit, the mbind failure for a node that does not exist is reported
+  HugePageAllocator<size_t> missing_node{HugePageSize::Huge2MB, 63};
+  REQUIRE_THROWS_AS((void)missing_node.allocate(1024), std::system_error);
+
+  HugePageAllocator<size_t> out_of_range{HugePageSize::Huge2MB, 64};
+  REQUIRE_THROWS_AS((void)out_of_range.allocate(1024), std::system_error);
+}
+#endif
+
+TEST_SUITE_END();
@@ -0,0 +1,131 @@
+#include "doctest/doctest.h"
+
+#include "lockfree_queues/instrumented_sp_broadcast_queue.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+TEST_SUITE_BEGIN("InstrumentedSPBroadcastQueue");
+
+using namespace lockfree_queues;
+
+/***/
+TEST_CASE("instrumented_front_records_once_per_element")
+{
+  InstrumentedSPBroadcastQueue<std::string, 2> q{16, 1};
+
+  size_t const reader_1 = q.subscribe();
+  size_t const reader_2 = q.subscribe();
+
+  REQUIRE_EQ(q.front(reader_1), nullptr);
+
+  for (size_t i = 0; i < 8; ++i)
+  {
+    q.emplace(std::to_string(i));
+  }
+
+  for (size_t i = 0; i < 8; ++i)
+  {
+    // front() twice on the same element only measures it once
+    REQUIRE_EQ(*q.front(reader_1), std::to_string(i));
+    REQUIRE_EQ(*q.front(reader_1), std::to_string(i));
+    q.pop(reader_1);
+  }
+
+  REQUIRE_EQ(q.front(reader_1), nullptr);
+  REQUIRE_EQ(q.latency_histogram(reader_1).count(), 8);
+  REQUIRE_EQ(q.latency_histogram(reader_2).count(), 0);
+
+  REQUIRE_EQ(*q.front(reader_2), "0");
+  REQUIRE_EQ(q.latency_histogram(reader_2).count(), 1);
+}
+
+/***/
+TEST_CASE("instrumented_subscribe_after_publish")
+{
+  InstrumentedSPBroadcastQueue<size_t, 2> q{16, 1};
+
+  size_t const early_reader = q.subscribe();
+
+  for (size_t i = 0; i < 4; ++i)
+  {
+    q.emplace(i);
+  }
+
+  // the late reader starts from the last element published before it joined, which is not measured
+  size_t const late_reader = q.subscribe();
+  REQUIRE_EQ(*q.front(late_reader), 3);
+  q.pop(late_reader);
+  REQUIRE_EQ(q.latency_histogram(late_reader).count(), 0);
+
+  for (size_t i = 4; i < 10; ++i)
+  {
+    q.emplace(i);
+  }
+
+  size_t popped = 0;
+  while (size_t const* item = q.front(late_reader))
+  {
+    REQUIRE_EQ(*item, popped + 4);
+    q.pop(late_reader);
+    ++popped;
+  }
+
+  REQUIRE_EQ(popped, 6);
+  REQUIRE_EQ(q.latency_histogram(late_reader).count(), popped);
+
+  for (size_t i = 0; i < 10; ++i)
+  {
+    REQUIRE_EQ(*q.front(early_reader), i);
+    q.pop(early_reader);
+  }
+
+  REQUIRE_EQ(q.latency_histogram(early_reader).count(), 10);
+}
+
+/***/
+TEST_CASE("single_produce_instrumented_consumer")
+{
+  InstrumentedSPBroadcastQueue<uint64_t> q{1024};
+  size_t const reader_id = q.subscribe();
+
+  uint64_t const iterations = 100'000;
+  std::atomic<bool> mismatch{false};
+
+  std::thread consumer{[&]()
+                       {
+                         for (uint64_t i = 0; i < iterations; ++i)
+                         {
+                           uint64_t const* v;
+                           while ((v = q.front(reader_id)) == nullptr)
+                           {
+                             std::this_thread::yield();
+                           }
+
+                           if (*v != i)
+                           {
+                             mismatch = true;
+                           }
+
+                           q.pop(reader_id);
+                         }
+                       }};
+
+  for (uint64_t i = 0; i < iterations; ++i)
+  {
+    while (!q.try_emplace(i))
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  consumer.join();
+
+  REQUIRE_FALSE(mismatch.load());
+  REQUIRE_EQ(q.latency_histogram(reader_id).count(), iterations);
+  REQUIRE_LE(q.latency_histogram(reader_id).percentile(50.0), q.latency_histogram(reader_id).max());
+}
+
+TEST_SUITE_END();
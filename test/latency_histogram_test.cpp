@@ -0,0 +1,84 @@
+#include "doctest/doctest.h"
+
+#include "lockfree_queues/latency_histogram.h"
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <thread>
+
+TEST_SUITE_BEGIN("LatencyHistogram");
+
+using namespace lockfree_queues;
+
+/***/
+TEST_CASE("bucket_index")
+{
+  // small values have a bucket each
+  for (uint64_t i = 0; i < LatencyHistogram::SUB_BUCKETS; ++i)
+  {
+    REQUIRE_EQ(LatencyHistogram::bucket_index(i), i);
+    REQUIRE_EQ(LatencyHistogram::bucket_highest_value(i), i);
+  }
+
+  REQUIRE_EQ(LatencyHistogram::bucket_index(16), 16);
+  REQUIRE_EQ(LatencyHistogram::bucket_index(31), 31);
+  REQUIRE_EQ(LatencyHistogram::bucket_index(32), 32);
+  REQUIRE_EQ(LatencyHistogram::bucket_index(33), 32);
+  REQUIRE_EQ(LatencyHistogram::bucket_highest_value(32), 33);
+
+  REQUIRE_EQ(LatencyHistogram::bucket_index(std::numeric_limits<uint64_t>::max()), LatencyHistogram::BUCKETS - 1);
+  REQUIRE_EQ(LatencyHistogram::bucket_highest_value(LatencyHistogram::BUCKETS - 1), std::numeric_limits<uint64_t>::max());
+
+  // every value falls in a bucket whose highest value is within the relative error
+  for (uint64_t value = 1; value < 10'000'000; value = value * 3 + 7)
+  {
+    uint64_t const highest = LatencyHistogram::bucket_highest_value(LatencyHistogram::bucket_index(value));
+    REQUIRE_GE(highest, value);
+    REQUIRE_LE(highest - value, value / LatencyHistogram::SUB_BUCKETS);
+  }
+}
+
+/***/
+TEST_CASE("percentile")
+{
+  LatencyHistogram histogram;
+
+  REQUIRE_EQ(histogram.count(), 0);
+  REQUIRE_EQ(histogram.percentile(50.0), 0);
+
+  for (uint64_t i = 1; i <= 1000; ++i)
+  {
+    histogram.record(i);
+  }
+
+  REQUIRE_EQ(histogram.count(), 1000);
+  REQUIRE_EQ(histogram.max(), 1000);
+  REQUIRE_EQ(histogram.percentile(100.0), 1000);
+  REQUIRE_EQ(histogram.percentile(0.0), 1);
+
+  uint64_t const p50 = histogram.percentile(50.0);
+  REQUIRE_GE(p50, 500);
+  REQUIRE_LE(p50, 500 + 500 / LatencyHistogram::SUB_BUCKETS);
+
+  uint64_t const p99 = histogram.percentile(99.0);
+  REQUIRE_GE(p99, 990);
+  REQUIRE_LE(p99, 1000);
+}
+
+/***/
+TEST_CASE("tsc_clock")
+{
+  TscClock clock{std::chrono::milliseconds{5}};
+
+  REQUIRE_GT(clock.ns_per_tick(), 0.0);
+
+  uint64_t const start = clock.now();
+  std::this_thread::sleep_for(std::chrono::milliseconds{20});
+  uint64_t const stop = clock.now();
+
+  REQUIRE_GE(stop, start);
+  REQUIRE_GE(clock.to_ns(stop - start), 10'000'000);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,172 @@
+#include "doctest/doctest.h"
+
+#include "lockfree_queues/mpmc_queue.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+TEST_SUITE_BEGIN("MPMCQueue");
+
+using namespace lockfree_queues;
+
+/***/
+TEST_CASE("mpmc_basic_produce_full_queue")
+{
+  MPMCQueue<std::shared_ptr<size_t>> q{16};
+  auto const value = std::make_shared<size_t>(1);
+
+  REQUIRE_EQ(q.capacity(), 16);
+
+  std::shared_ptr<size_t> out;
+  REQUIRE_FALSE(q.try_pop(out));
+
+  for (size_t iter = 0; iter < 3; ++iter)
+  {
+    for (size_t i = 0; i < 16; i++)
+    {
+      REQUIRE(q.try_emplace(value));
+    }
+
+    REQUIRE_FALSE(q.try_emplace(value));
+    REQUIRE_EQ(value.use_count(), 17);
+
+    for (size_t i = 0; i < 16; i++)
+    {
+      REQUIRE(q.try_pop(out));
+      REQUIRE_EQ(out.get(), value.get());
+    }
+
+    REQUIRE_FALSE(q.try_pop(out));
+    out.reset();
+    REQUIRE_EQ(value.use_count(), 1);
+  }
+
+  // elements left in the queue are destroyed by the queue
+  {
+    MPMCQueue<std::shared_ptr<size_t>> q2{16};
+    q2.emplace(value);
+    q2.emplace(value);
+    REQUIRE_EQ(value.use_count(), 3);
+  }
+  REQUIRE_EQ(value.use_count(), 1);
+}
+
+/***/
+TEST_CASE("mpmc_emplace_n_pop_n")
+{
+  MPMCQueue<size_t> q{16};
+
+  std::vector<size_t> values{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  std::vector<size_t> out(16);
+
+  for (size_t iter = 0; iter < 3; ++iter)
+  {
+    REQUIRE(q.try_emplace_n(values.begin(), values.end()));
+    REQUIRE_FALSE(q.try_emplace_n(values.begin(), values.end()));
+    REQUIRE(q.try_emplace_n(values.begin(), values.begin() + 6));
+
+    REQUIRE_EQ(q.try_pop_n(out.begin(), 4), 4);
+    REQUIRE_EQ(q.try_pop_n(out.begin() + 4, 16), 12);
+    REQUIRE_EQ(q.try_pop_n(out.begin(), 16), 0);
+
+    for (size_t i = 0; i < 16; i++)
+    {
+      REQUIRE_EQ(out[i], i < 10 ? i : i - 10);
+    }
+  }
+}
+
+/***/
+TEST_CASE("mpmc_multiple_producers_multiple_consumers")
+{
+  const size_t iter = 100'000;
+  constexpr size_t PRODUCERS = 2;
+  constexpr size_t CONSUMERS = 3;
+  MPMCQueue<size_t> q{1024};
+
+  std::vector<std::thread> producers;
+  for (size_t tid = 0; tid < PRODUCERS; ++tid)
+  {
+    producers.emplace_back(
+      [&q, tid, iter]()
+      {
+        for (size_t i = 0; i < iter; ++i)
+        {
+          if (tid == 0)
+          {
+            q.emplace(i);
+          }
+          else
+          {
+            while (!q.try_emplace(i))
+            {
+              std::this_thread::yield();
+            }
+          }
+        }
+      });
+  }
+
+  std::atomic<size_t> consumed{0};
+  std::atomic<size_t> sum{0};
+
+  std::vector<std::thread> consumers;
+  for (size_t tid = 0; tid < CONSUMERS; ++tid)
+  {
+    consumers.emplace_back(
+      [&q, &consumed, &sum, tid, iter]()
+      {
+        std::array<size_t, 8> batch;
+        size_t local_sum = 0;
+
+        while (consumed.load() < iter * PRODUCERS)
+        {
+          size_t n = 0;
+          if (tid == 0)
+          {
+            n = q.try_pop_n(batch.begin(), batch.size());
+          }
+          else
+          {
+            n = q.try_pop(batch[0]) ? 1 : 0;
+          }
+
+          if (n == 0)
+          {
+            std::this_thread::yield();
+            continue;
+          }
+
+          for (size_t i = 0; i < n; ++i)
+          {
+            local_sum += batch[i];
+          }
+          consumed += n;
+        }
+
+        sum += local_sum;
+      });
+  }
+
+  for (auto& p : producers)
+  {
+    p.join();
+  }
+
+  for (auto& c : consumers)
+  {
+    c.join();
+  }
+
+  // each element was consumed exactly once
+  REQUIRE_EQ(consumed.load(), iter * PRODUCERS);
+  REQUIRE_EQ(sum.load(), PRODUCERS * iter * (iter - 1) / 2);
+
+  size_t out;
+  REQUIRE_FALSE(q.try_pop(out));
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,168 @@
+#include "doctest/doctest.h"
+
+#include "lockfree_queues/mpsc_queue.h"
+
+#include <array>
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+TEST_SUITE_BEGIN("MPSCQueue");
+
+using namespace lockfree_queues;
+
+// TestType tracks correct usage of constructors and destructors
+struct MPSCTestType
+{
+  static std::set<MPSCTestType const*> constructed;
+
+  MPSCTestType(size_t v) noexcept
+  {
+    x = v;
+    REQUIRE_EQ(constructed.count(this), 0);
+    constructed.insert(this);
+  };
+
+  MPSCTestType() noexcept
+  {
+    REQUIRE_EQ(constructed.count(this), 0);
+    constructed.insert(this);
+  };
+
+  MPSCTestType(const MPSCTestType& other) noexcept
+  {
+    REQUIRE_EQ(constructed.count(this), 0);
+    REQUIRE_EQ(constructed.count(&other), 1);
+    constructed.insert(this);
+  };
+
+  ~MPSCTestType() noexcept
+  {
+    REQUIRE_EQ(constructed.count(this), 1);
+    constructed.erase(this);
+  };
+
+  size_t x;
+};
+
+std::set<const MPSCTestType*> MPSCTestType::constructed;
+
+/***/
+TEST_CASE("mpsc_basic_produce_full_queue")
+{
+  {
+    MPSCQueue<MPSCTestType> q{16};
+
+    REQUIRE_EQ(q.front(), nullptr);
+    REQUIRE_EQ(q.capacity(), 16);
+
+    for (size_t iter = 0; iter < 3; ++iter)
+    {
+      for (size_t i = 0; i < 16; i++)
+      {
+        REQUIRE_EQ(q.try_emplace(i), true);
+      }
+
+      REQUIRE_EQ(MPSCTestType::constructed.size(), 16);
+      REQUIRE_EQ(q.try_emplace(), false);
+
+      for (size_t i = 0; i < 16; i++)
+      {
+        REQUIRE_EQ(q.front()->x, i);
+        q.pop();
+      }
+
+      REQUIRE_EQ(q.front(), nullptr);
+      REQUIRE_EQ(MPSCTestType::constructed.size(), 0);
+    }
+
+    // elements left in the queue are destroyed by the queue
+    for (size_t i = 0; i < 10; i++)
+    {
+      q.emplace(i);
+    }
+  }
+  REQUIRE_EQ(MPSCTestType::constructed.size(), 0);
+}
+
+/***/
+TEST_CASE("mpsc_emplace_n")
+{
+  {
+    MPSCQueue<MPSCTestType> q{16};
+
+    std::vector<size_t> values{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+    for (size_t iter = 0; iter < 3; ++iter)
+    {
+      REQUIRE(q.try_emplace_n(values.begin(), values.end()));
+      REQUIRE_FALSE(q.try_emplace_n(values.begin(), values.end()));
+      REQUIRE(q.try_emplace_n(values.begin(), values.begin() + 6));
+      REQUIRE_FALSE(q.try_emplace_n(values.begin(), values.begin() + 1));
+
+      for (size_t i = 0; i < 16; i++)
+      {
+        REQUIRE_EQ(q.front()->x, i < 10 ? i : i - 10);
+        q.pop();
+      }
+    }
+  }
+  REQUIRE_EQ(MPSCTestType::constructed.size(), 0);
+}
+
+/***/
+TEST_CASE("mpsc_multiple_producers_single_consumer")
+{
+  const size_t iter = 100'000;
+  constexpr size_t PRODUCERS = 4;
+  MPSCQueue<std::pair<size_t, size_t>> q{1024};
+
+  std::vector<std::thread> producers;
+  for (size_t tid = 0; tid < PRODUCERS; ++tid)
+  {
+    producers.emplace_back(
+      [&q, tid, iter]()
+      {
+        for (size_t i = 0; i < iter; ++i)
+        {
+          if (tid % 2 == 0)
+          {
+            q.emplace(tid, i);
+          }
+          else
+          {
+            while (!q.try_emplace(tid, i))
+            {
+              std::this_thread::yield();
+            }
+          }
+        }
+      });
+  }
+
+  // each producer's messages are received in order
+  std::array<size_t, PRODUCERS> next{};
+  for (size_t i = 0; i < iter * PRODUCERS; ++i)
+  {
+    std::pair<size_t, size_t>* item = q.front();
+    while (!item)
+    {
+      std::this_thread::yield();
+      item = q.front();
+    }
+
+    REQUIRE_EQ(item->second, next[item->first]);
+    next[item->first] += 1;
+    q.pop();
+  }
+
+  REQUIRE_EQ(q.front(), nullptr);
+
+  for (auto& p : producers)
+  {
+    p.join();
+  }
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,275 @@
+#include "doctest/doctest.h"
+
+#include "lockfree_queues/shm_sp_broadcast_queue.h"
+
+#include <array>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+TEST_SUITE_BEGIN("ShmSPBroadcastQueue");
+
+using namespace lockfree_queues;
+
+struct ShmTestType
+{
+  size_t x;
+  size_t y;
+};
+
+std::string shm_test_name(char const* test_name)
+{
+  return std::string{"/lfq_"} + test_name + "_" + std::to_string(::getpid());
+}
+
+/***/
+TEST_CASE("shm_attach_same_process")
+{
+  std::string const name = shm_test_name("attach");
+
+  ShmSPBroadcastQueue<ShmTestType, 2> producer_q{name, 16};
+  ShmSPBroadcastQueue<ShmTestType, 2> consumer_q{name};
+
+  REQUIRE_EQ(consumer_q.capacity(), 16);
+
+  size_t const rid = consumer_q.subscribe();
+  REQUIRE_EQ(consumer_q.front(rid), nullptr);
+
+  for (size_t iter = 0; iter < 3; ++iter)
+  {
+    for (size_t i = 0; i < 16; i++)
+    {
+      REQUIRE(producer_q.try_emplace(ShmTestType{i, iter}));
+    }
+
+    REQUIRE_FALSE(producer_q.try_emplace(ShmTestType{0, 0}));
+
+    for (size_t i = 0; i < 16; i++)
+    {
+      ShmTestType const* item = consumer_q.front(rid);
+      REQUIRE(item);
+      REQUIRE_EQ(item->x, i);
+      REQUIRE_EQ(item->y, iter);
+      consumer_q.pop(rid);
+    }
+  }
+
+  consumer_q.unsubscribe(rid);
+}
+
+/***/
+TEST_CASE("shm_attach_errors")
+{
+  std::string const name = shm_test_name("errors");
+
+  REQUIRE_THROWS((void)ShmSPBroadcastQueue<ShmTestType>{name});
+
+  ShmSPBroadcastQueue<ShmTestType> producer_q{name, 16};
+  REQUIRE_THROWS((ShmSPBroadcastQueue<ShmTestType>{name, 16}));
+
+  // layout mismatch
+  REQUIRE_THROWS((void)ShmSPBroadcastQueue<ShmTestType, 2>{name});
+  REQUIRE_THROWS((void)ShmSPBroadcastQueue<size_t>{name});
+}
+
+/***/
+TEST_CASE("shm_single_produce_multiple_consumer_processes")
+{
+  std::string const name = shm_test_name("processes");
+  const size_t iter = 100'000;
+  constexpr size_t MAX_CONSUMERS = 2;
+
+  ShmSPBroadcastQueue<ShmTestType, MAX_CONSUMERS> q{name, 1024};
+
+  // each consumer writes to the pipe once subscribed
+  int subscribed_pipe[2];
+  REQUIRE_EQ(::pipe(subscribed_pipe), 0);
+
+  std::array<pid_t, MAX_CONSUMERS> children;
+  for (auto& child : children)
+  {
+    child = ::fork();
+    REQUIRE_NE(child, -1);
+
+    if (child == 0)
+    {
+      // consumer process
+      int result = 0;
+      {
+        ShmSPBroadcastQueue<ShmTestType, MAX_CONSUMERS> consumer_q{name};
+        size_t const rid = consumer_q.subscribe();
+
+        char const subscribed{1};
+        if (::write(subscribed_pipe[1], &subscribed, 1) != 1)
+        {
+          ::_exit(2);
+        }
+
+        for (size_t i = 0; i < iter; ++i)
+        {
+          ShmTestType const* item = consumer_q.front(rid);
+          while (!item)
+          {
+            item = consumer_q.front(rid);
+          }
+
+          if ((item->x != i) || (item->y != i * 2))
+          {
+            result = 1;
+          }
+
+          consumer_q.pop(rid);
+        }
+
+        consumer_q.unsubscribe(rid);
+      }
+      ::_exit(result);
+    }
+  }
+
+  for (size_t i = 0; i < MAX_CONSUMERS; ++i)
+  {
+    char subscribed;
+    REQUIRE_EQ(::read(subscribed_pipe[0], &subscribed, 1), 1);
+  }
+
+  ::close(subscribed_pipe[0]);
+  ::close(subscribed_pipe[1]);
+
+  for (size_t i = 0; i < iter; ++i)
+  {
+    q.emplace(ShmTestType{i, i * 2});
+  }
+
+  for (pid_t child : children)
+  {
+    int status = 0;
+    REQUIRE_EQ(::waitpid(child, &status, 0), child);
+    REQUIRE(WIFEXITED(status));
+    REQUIRE_EQ(WEXITSTATUS(status), 0);
+  }
+}
+
+/***/
+TEST_CASE("shm_reclaim_dead_reader")
+{
+  std::string const name = shm_test_name("reclaim");
+
+  ShmSPBroadcastQueue<ShmTestType, 2> q{name, 16};
+
+  pid_t const child = ::fork();
+  REQUIRE_NE(child, -1);
+
+  if (child == 0)
+  {
+    // the consumer process dies while subscribed
+    ShmSPBroadcastQueue<ShmTestType, 2> consumer_q{name};
+    (void)consumer_q.subscribe();
+    ::_exit(0);
+  }
+
+  int status = 0;
+  REQUIRE_EQ(::waitpid(child, &status, 0), child);
+  REQUIRE(WIFEXITED(status));
+
+  REQUIRE_EQ(q.owner_pid(0), child);
+  REQUIRE_EQ(q.owner_pid(1), 0);
+
+  // the dead reader holds back the producer
+  for (size_t i = 0; i < 16; i++)
+  {
+    REQUIRE(q.try_emplace(ShmTestType{i, i}));
+  }
+  REQUIRE_FALSE(q.try_emplace(ShmTestType{0, 0}));
+
+  REQUIRE_EQ(q.reclaim_dead_readers(), 1);
+  REQUIRE_EQ(q.reclaim_dead_readers(), 0);
+  REQUIRE_EQ(q.owner_pid(0), 0);
+
+  // the slot can be claimed again
+  size_t const rid = q.subscribe();
+  REQUIRE_EQ(rid, 0);
+  REQUIRE_EQ(q.owner_pid(rid), ::getpid());
+  REQUIRE_EQ(q.reclaim_dead_readers(), 0);
+
+  REQUIRE(q.try_emplace(ShmTestType{16, 16}));
+
+  q.unsubscribe(rid);
+  REQUIRE_EQ(q.owner_pid(rid), 0);
+}
+
+/***/
+TEST_CASE("shm_force_unsubscribe")
+{
+  std::string const name = shm_test_name("force_unsubscribe");
+
+  ShmSPBroadcastQueue<ShmTestType, 2> producer_q{name, 16};
+  ShmSPBroadcastQueue<ShmTestType, 2> consumer_q{name};
+
+  size_t const stuck_rid = consumer_q.subscribe();
+
+  for (size_t i = 0; i < 16; i++)
+  {
+    REQUIRE(producer_q.try_emplace(ShmTestType{i, i}));
+  }
+  REQUIRE_FALSE(producer_q.try_emplace(ShmTestType{0, 0}));
+
+  // the producer frees the slot of the stuck reader
+  producer_q.force_unsubscribe(stuck_rid);
+  REQUIRE_EQ(producer_q.owner_pid(stuck_rid), 0);
+
+  size_t const rid = consumer_q.subscribe();
+
+  // the new reader starts from the last element written
+  ShmTestType const* item = consumer_q.front(rid);
+  REQUIRE(item);
+  REQUIRE_EQ(item->x, 15);
+  consumer_q.pop(rid);
+
+  REQUIRE(producer_q.try_emplace(ShmTestType{16, 16}));
+  item = consumer_q.front(rid);
+  REQUIRE(item);
+  REQUIRE_EQ(item->x, 16);
+}
+
+/***/
+TEST_CASE("shm_unsubscribe_after_force_unsubscribe")
+{
+  std::string const name = shm_test_name("unsubscribe_after_force");
+
+  ShmSPBroadcastQueue<ShmTestType, 1> q{name, 16};
+
+  size_t const stale_rid = q.subscribe();
+  q.force_unsubscribe(stale_rid);
+
+  pid_t const child = ::fork();
+  REQUIRE_NE(child, -1);
+
+  if (child == 0)
+  {
+    // another process claims the freed slot
+    ShmSPBroadcastQueue<ShmTestType, 1> consumer_q{name};
+    (void)consumer_q.subscribe();
+    ::_exit(0);
+  }
+
+  int status = 0;
+  REQUIRE_EQ(::waitpid(child, &status, 0), child);
+  REQUIRE(WIFEXITED(status));
+  REQUIRE_EQ(q.owner_pid(stale_rid), child);
+
+  // the late unsubscribe of the previous owner leaves the slot of the new owner alone
+  q.unsubscribe(stale_rid);
+  REQUIRE_EQ(q.owner_pid(stale_rid), child);
+
+  for (size_t i = 0; i < 16; i++)
+  {
+    REQUIRE(q.try_emplace(ShmTestType{i, i}));
+  }
+  REQUIRE_FALSE(q.try_emplace(ShmTestType{0, 0}));
+
+  REQUIRE_EQ(q.reclaim_dead_readers(), 1);
+  REQUIRE_EQ(q.owner_pid(stale_rid), 0);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,171 @@
+#include "doctest/doctest.h"
+
+#include "lockfree_queues/sp_broadcast_byte_queue.h"
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_SUITE_BEGIN("SPBroadcastByteQueue");
+
+using namespace lockfree_queues;
+
+/***/
+TEST_CASE("byte_queue_variable_size_records")
+{
+  SPBroadcastByteQueue<> q{256};
+  size_t const rid = q.subscribe();
+
+  REQUIRE_EQ(q.capacity(), 256);
+  REQUIRE_EQ(q.front(rid).data, nullptr);
+
+  for (size_t iter = 0; iter < 100; ++iter)
+  {
+    // records of different sizes, wrapping around the end of the buffer at different offsets
+    std::string const message(iter % 40, static_cast<char>('a' + iter % 26));
+    REQUIRE(q.try_push(message.data(), message.size()));
+
+    auto const record = q.front(rid);
+    REQUIRE(record.data);
+    REQUIRE_EQ(record.size, message.size());
+    REQUIRE_EQ(std::string{reinterpret_cast<char const*>(record.data), record.size}, message);
+    q.pop(rid);
+
+    REQUIRE_EQ(q.front(rid).data, nullptr);
+  }
+}
+
+/***/
+TEST_CASE("byte_queue_full")
+{
+  SPBroadcastByteQueue<> q{256};
+  size_t const rid = q.subscribe();
+
+  REQUIRE_FALSE(q.try_reserve(q.max_record_size() + 1));
+
+  // 24 bytes per record including the header
+  std::array<char, 16> message{};
+  size_t pushed = 0;
+  while (q.try_push(message.data(), message.size()))
+  {
+    ++pushed;
+  }
+
+  REQUIRE_EQ(pushed, 256 / 24);
+
+  for (size_t i = 0; i < pushed; ++i)
+  {
+    REQUIRE(q.front(rid).data);
+    q.pop(rid);
+  }
+
+  REQUIRE_EQ(q.front(rid).data, nullptr);
+
+  // the largest record always fits once the reader catches up
+  for (size_t i = 0; i < 10; ++i)
+  {
+    std::byte* record = q.try_reserve(q.max_record_size());
+    REQUIRE(record);
+    std::memset(record, static_cast<int>(i), q.max_record_size());
+    q.commit();
+
+    auto const r = q.front(rid);
+    REQUIRE_EQ(r.size, q.max_record_size());
+    REQUIRE_EQ(r.data[r.size - 1], static_cast<std::byte>(i));
+    q.pop(rid);
+  }
+}
+
+/***/
+TEST_CASE("byte_queue_invalid_arguments")
+{
+  REQUIRE_THROWS_AS(SPBroadcastByteQueue<>(256, 0), std::runtime_error);
+  REQUIRE_THROWS_AS(SPBroadcastByteQueue<>(256, 1), std::runtime_error);
+  REQUIRE_THROWS_AS(SPBroadcastByteQueue<>(256, 3), std::runtime_error);
+
+  SPBroadcastByteQueue<> q{256};
+  size_t const rid = q.subscribe();
+
+  // a record greater than max_record_size() never fits, push() rejects it instead of spinning
+  std::vector<char> const message(q.max_record_size() + 1, 'a');
+  REQUIRE_FALSE(q.try_push(message.data(), message.size()));
+  REQUIRE_THROWS_AS(q.push(message.data(), message.size()), std::invalid_argument);
+  REQUIRE_EQ(q.front(rid).data, nullptr);
+
+  q.push(message.data(), q.max_record_size());
+  REQUIRE_EQ(q.front(rid).size, q.max_record_size());
+}
+
+/***/
+TEST_CASE("byte_queue_single_produce_multiple_consumers")
+{
+  const size_t iter = 100'000;
+  constexpr size_t MAX_CONSUMERS = 2;
+  SPBroadcastByteQueue<MAX_CONSUMERS> q{65536};
+
+  std::array<std::atomic<bool>, MAX_CONSUMERS> flags = {false};
+
+  std::thread producer{[&q, &flags, iter]()
+                       {
+                         for (auto const& flag : flags)
+                         {
+                           while (!flag)
+                             ;
+                         }
+
+                         std::array<size_t, 32> message;
+                         for (size_t i = 0; i < iter; ++i)
+                         {
+                           size_t const n = 1 + i % message.size();
+                           std::fill_n(message.begin(), n, i);
+                           while (!q.try_push(message.data(), n * sizeof(size_t)))
+                           {
+                             std::this_thread::yield();
+                           }
+                         }
+                       }};
+
+  std::vector<std::thread> consumers;
+  for (size_t tid = 0; tid < MAX_CONSUMERS; ++tid)
+  {
+    consumers.emplace_back(
+      [&q, &flags, tid, iter]()
+      {
+        size_t rid = q.subscribe();
+        flags[tid] = true;
+
+        for (size_t i = 0; i < iter; ++i)
+        {
+          auto record = q.front(rid);
+          while (!record.data)
+          {
+            std::this_thread::yield();
+            record = q.front(rid);
+          }
+
+          size_t const n = 1 + i % 32;
+          REQUIRE_EQ(record.size, n * sizeof(size_t));
+
+          size_t last;
+          std::memcpy(&last, record.data + record.size - sizeof(size_t), sizeof(size_t));
+          REQUIRE_EQ(last, i);
+
+          q.pop(rid);
+        }
+
+        REQUIRE_EQ(q.front(rid).data, nullptr);
+        q.unsubscribe(rid);
+      });
+  }
+
+  for (auto& c : consumers)
+  {
+    c.join();
+  }
+  producer.join();
+}
+
+TEST_SUITE_END();
@@ -3,6 +3,7 @@
 #include "lockfree_queues/sp_broadcast_queue.h"
 
 #include <array>
+#include <chrono>
 #include <memory>
 #include <set>
 #include <thread>
@@ -122,6 +123,174 @@ TEST_CASE("basic_produce_partial_queue")
   REQUIRE_EQ(SPBQTestType::constructed.size(), 0);
 }
 
+/***/
+TEST_CASE("reserve_commit")
+{
+  {
+    SPBroadcastQueue<SPBQTestType> q{16};
+    size_t const rid = q.subscribe();
+
+    for (size_t iter = 0; iter < 3; ++iter)
+    {
+      for (size_t i = 0; i < 16; i++)
+      {
+        SPBQTestType* slot = q.try_reserve();
+        REQUIRE(slot);
+        ::new (static_cast<void*>(slot)) SPBQTestType{iter * 16 + i};
+        q.commit();
+      }
+
+      REQUIRE_EQ(q.try_reserve(), nullptr);
+      REQUIRE_EQ(SPBQTestType::constructed.size(), 16);
+
+      for (size_t i = 0; i < 16; i++)
+      {
+        SPBQTestType const* item = q.front(rid);
+        REQUIRE(item);
+        REQUIRE_EQ(item->x, iter * 16 + i);
+        q.pop(rid);
+      }
+
+      REQUIRE_EQ(q.front(rid), nullptr);
+    }
+  }
+  REQUIRE_EQ(SPBQTestType::constructed.size(), 0);
+}
+
+/***/
+TEST_CASE("emplace_n")
+{
+  {
+    SPBroadcastQueue<SPBQTestType> q{16};
+    size_t const rid = q.subscribe();
+
+    std::vector<size_t> values(10);
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+      values[i] = i;
+    }
+
+    for (size_t iter = 0; iter < 3; ++iter)
+    {
+      REQUIRE(q.try_emplace_n(values.begin(), values.end()));
+
+      // not enough space for another 10 elements, nothing is written
+      REQUIRE_FALSE(q.try_emplace_n(values.begin(), values.end()));
+      REQUIRE(q.try_emplace_n(values.begin(), values.begin() + 6));
+      REQUIRE_FALSE(q.try_emplace_n(values.begin(), values.begin() + 1));
+
+      for (size_t i = 0; i < 16; i++)
+      {
+        SPBQTestType const* item = q.front(rid);
+        REQUIRE(item);
+        REQUIRE_EQ(item->x, i < 10 ? i : i - 10);
+        q.pop(rid);
+      }
+
+      REQUIRE_EQ(q.front(rid), nullptr);
+    }
+
+    // a range larger than the capacity never fits
+    std::vector<size_t> large(17);
+    REQUIRE_FALSE(q.try_emplace_n(large.begin(), large.end()));
+    REQUIRE(q.try_emplace_n(large.begin(), large.begin()));
+  }
+  REQUIRE_EQ(SPBQTestType::constructed.size(), 0);
+}
+
+/***/
+TEST_CASE("emplace_n_empty_range")
+{
+  SPBroadcastQueue<SPBQTestType> q{16};
+  std::vector<size_t> values(4);
+
+  // an empty range always succeeds, like MPMCQueue, even without readers
+  REQUIRE(q.try_emplace_n(values.begin(), values.begin()));
+
+  size_t const rid = q.subscribe();
+
+  // and even when the queue is full
+  for (size_t i = 0; i < 16; ++i)
+  {
+    REQUIRE(q.try_emplace(i));
+  }
+
+  REQUIRE_FALSE(q.try_emplace_n(values.begin(), values.begin() + 1));
+  REQUIRE(q.try_emplace_n(values.begin(), values.begin()));
+
+  for (size_t i = 0; i < 16; ++i)
+  {
+    REQUIRE(q.front(rid));
+    q.pop(rid);
+  }
+
+  REQUIRE_EQ(q.front(rid), nullptr);
+}
+
+/***/
+TEST_CASE("read_available_pop_n")
+{
+  {
+    SPBroadcastQueue<SPBQTestType> q{16};
+    size_t const rid = q.subscribe();
+
+    REQUIRE(q.read_available(rid).empty());
+
+    for (size_t i = 0; i < 12; i++)
+    {
+      q.emplace(i);
+    }
+
+    auto view = q.read_available(rid);
+    REQUIRE_EQ(view.size(), 12);
+    REQUIRE_EQ(view.first.size, 12);
+    REQUIRE_EQ(view.second.size, 0);
+
+    size_t expected = 0;
+    for (SPBQTestType const& item : view.first)
+    {
+      REQUIRE_EQ(item.x, expected++);
+    }
+
+    q.pop_n(rid, 12);
+    REQUIRE(q.read_available(rid).empty());
+
+    // wrap around the end of the buffer
+    for (size_t i = 0; i < 16; i++)
+    {
+      q.emplace(i);
+    }
+
+    view = q.read_available(rid);
+    REQUIRE_EQ(view.size(), 16);
+    REQUIRE_EQ(view.first.size, 4);
+    REQUIRE_EQ(view.second.size, 12);
+
+    expected = 0;
+    for (auto const& span : {view.first, view.second})
+    {
+      for (SPBQTestType const& item : span)
+      {
+        REQUIRE_EQ(item.x, expected++);
+      }
+    }
+
+    // the queue is full until the reader consumes
+    REQUIRE_FALSE(q.try_emplace());
+
+    q.pop_n(rid, 3);
+    REQUIRE_EQ(q.front(rid)->x, 3);
+    q.pop_n(rid, 13);
+    REQUIRE_EQ(q.front(rid), nullptr);
+
+    for (size_t i = 0; i < 16; i++)
+    {
+      REQUIRE(q.try_emplace(i));
+    }
+  }
+  REQUIRE_EQ(SPBQTestType::constructed.size(), 0);
+}
+
 /***/
 TEST_CASE("over_subscribe")
 {
@@ -340,4 +509,1290 @@ TEST_CASE("single_produce_multiple_consumers_subscribe")
   }
   producer.join();
 }
+/***/
+TEST_CASE("single_produce_multiple_consumers_emplace_n")
+{
+  const size_t iter = 100'000;
+  const size_t batch = 8;
+  constexpr size_t MAX_CONSUMERS = 2;
+  SPBroadcastQueue<size_t, MAX_CONSUMERS> q{1024};
+
+  std::array<std::atomic<bool>, MAX_CONSUMERS> flags = {false};
+
+  std::thread producer{[&q, &flags, iter, batch]()
+                       {
+                         for (auto const& flag : flags)
+                         {
+                           while (!flag)
+                             ;
+                         }
+
+                         std::array<size_t, batch> values;
+                         for (size_t i = 0; i < iter; i += batch)
+                         {
+                           for (size_t j = 0; j < batch; ++j)
+                           {
+                             values[j] = i + j;
+                           }
+
+                           while (!q.try_emplace_n(values.begin(), values.end()))
+                             ;
+                         }
+                       }};
+
+  std::vector<std::thread> consumers;
+  for (size_t tid = 0; tid < MAX_CONSUMERS; ++tid)
+  {
+    consumers.emplace_back(
+      [&q, &flags, tid, iter]()
+      {
+        size_t rid = q.subscribe();
+        flags[tid] = true;
+
+        for (size_t i = 0; i < iter; ++i)
+        {
+          while (!q.front(rid))
+            ;
+          REQUIRE_EQ(*q.front(rid), i);
+          q.pop(rid);
+        }
+
+        REQUIRE_EQ(q.front(rid), nullptr);
+        q.unsubscribe(rid);
+      });
+  }
+
+  for (auto& c : consumers)
+  {
+    c.join();
+  }
+  producer.join();
+}
+
+/***/
+TEST_CASE("front_wait_timeout")
+{
+  SPBroadcastQueue<size_t, 1, std::allocator<size_t>, SleepWaitStrategy<>> q{16};
+  size_t const rid = q.subscribe();
+
+  auto const start = std::chrono::steady_clock::now();
+  REQUIRE_EQ(q.front_wait(rid, std::chrono::milliseconds{5}), nullptr);
+  REQUIRE_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds{5});
+
+  q.emplace(7u);
+  size_t const* item = q.front_wait(rid, std::chrono::milliseconds{5});
+  REQUIRE(item);
+  REQUIRE_EQ(*item, 7);
+}
+
+/***/
+template <typename TWaitStrategy>
+void test_wait_strategy()
+{
+  const size_t iter = 100'000;
+  constexpr size_t MAX_CONSUMERS = 2;
+  SPBroadcastQueue<size_t, MAX_CONSUMERS, std::allocator<size_t>, TWaitStrategy> q{64};
+
+  std::array<std::atomic<bool>, MAX_CONSUMERS> flags = {false};
+
+  std::thread producer{[&q, &flags, iter]()
+                       {
+                         for (auto const& flag : flags)
+                         {
+                           while (!flag)
+                             std::this_thread::yield();
+                         }
+
+                         for (size_t i = 0; i < iter; ++i)
+                         {
+                           q.emplace(i);
+                         }
+                       }};
+
+  std::vector<std::thread> consumers;
+  for (size_t tid = 0; tid < MAX_CONSUMERS; ++tid)
+  {
+    consumers.emplace_back(
+      [&q, &flags, tid, iter]()
+      {
+        size_t rid = q.subscribe();
+        size_t sum = 0;
+        flags[tid] = true;
+
+        for (size_t i = 0; i < iter; ++i)
+        {
+          sum += *q.front_wait(rid);
+          q.pop(rid);
+        }
+
+        REQUIRE_EQ(q.front(rid), nullptr);
+        REQUIRE_EQ(sum, iter * (iter - 1) / 2);
+        q.unsubscribe(rid);
+      });
+  }
+
+  for (auto& c : consumers)
+  {
+    c.join();
+  }
+  producer.join();
+}
+
+/***/
+TEST_CASE("single_produce_multiple_consumers_backoff_wait")
+{
+  test_wait_strategy<BackoffWaitStrategy<>>();
+}
+
+/***/
+TEST_CASE("single_produce_multiple_consumers_sleep_wait")
+{
+  test_wait_strategy<SleepWaitStrategy<>>();
+}
+
+/***/
+TEST_CASE("single_produce_multiple_consumers_parking_wait")
+{
+  test_wait_strategy<ParkingWaitStrategy<>>();
+}
+
+/***/
+TEST_CASE("parking_wait_idle_consumers")
+{
+  // The producer publishes in bursts with idle periods that let the consumers park
+  const size_t iter = 10;
+  constexpr size_t MAX_CONSUMERS = 2;
+  SPBroadcastQueue<size_t, MAX_CONSUMERS, std::allocator<size_t>, ParkingWaitStrategy<16, 100'000>> q{64};
+
+  std::array<std::atomic<bool>, MAX_CONSUMERS> flags = {false};
+
+  std::thread producer{[&q, &flags, iter]()
+                       {
+                         for (auto const& flag : flags)
+                         {
+                           while (!flag)
+                             std::this_thread::yield();
+                         }
+
+                         for (size_t i = 0; i < iter; ++i)
+                         {
+                           std::this_thread::sleep_for(std::chrono::milliseconds{2});
+                           q.emplace(i);
+                         }
+                       }};
+
+  std::vector<std::thread> consumers;
+  for (size_t tid = 0; tid < MAX_CONSUMERS; ++tid)
+  {
+    consumers.emplace_back(
+      [&q, &flags, tid, iter]()
+      {
+        size_t rid = q.subscribe();
+        flags[tid] = true;
+
+        for (size_t i = 0; i < iter; ++i)
+        {
+          size_t const* item = q.front_wait(rid);
+          REQUIRE_EQ(*item, i);
+          q.pop(rid);
+        }
+
+        q.unsubscribe(rid);
+      });
+  }
+
+  for (auto& c : consumers)
+  {
+    c.join();
+  }
+  producer.join();
+}
+
+/***/
+TEST_CASE("consumer_group")
+{
+  constexpr size_t MAX_CONSUMERS = 4;
+  SPBroadcastQueue<size_t, MAX_CONSUMERS> q{16};
+
+  REQUIRE_THROWS((void)q.subscribe_group(MAX_CONSUMERS));
+
+  size_t const reader = q.subscribe();
+  size_t const worker1 = q.subscribe_group(1);
+  size_t const worker2 = q.subscribe_group(1);
+
+  REQUIRE_EQ(q.try_claim(worker1), nullptr);
+  REQUIRE_EQ(q.try_claim(worker2), nullptr);
+
+  for (size_t iter = 0; iter < 4; ++iter)
+  {
+    for (size_t i = 0; i < 16; ++i)
+    {
+      REQUIRE(q.try_emplace(iter * 16 + i));
+    }
+
+    REQUIRE_FALSE(q.try_emplace(size_t{0}));
+
+    // the members of the group split the elements between them
+    for (size_t i = 0; i < 16; i += 2)
+    {
+      auto const* v1 = q.try_claim(worker1);
+      auto const* v2 = q.try_claim(worker2);
+      REQUIRE(v1);
+      REQUIRE(v2);
+      REQUIRE_EQ(*v1, iter * 16 + i);
+      REQUIRE_EQ(*v2, iter * 16 + i + 1);
+      q.release(worker2);
+      q.release(worker1);
+    }
+
+    REQUIRE_EQ(q.try_claim(worker1), nullptr);
+    REQUIRE_EQ(q.try_claim(worker2), nullptr);
+
+    // the group alone does not free the queue, the reader still sees all the elements
+    REQUIRE_FALSE(q.try_emplace(size_t{0}));
+
+    for (size_t i = 0; i < 16; ++i)
+    {
+      REQUIRE(q.front(reader));
+      REQUIRE_EQ(*q.front(reader), iter * 16 + i);
+      q.pop(reader);
+    }
+
+    REQUIRE_EQ(q.front(reader), nullptr);
+  }
+
+  // a member joining later starts at the claim cursor of the group
+  q.unsubscribe(worker2);
+  REQUIRE(q.try_emplace(size_t{100}));
+  size_t const worker3 = q.subscribe_group(1);
+  REQUIRE_EQ(*q.try_claim(worker3), 100);
+  q.release(worker3);
+  REQUIRE_EQ(q.try_claim(worker1), nullptr);
+  REQUIRE_EQ(q.try_claim(worker3), nullptr);
+
+  // a member that only polls an empty group does not hold back the producer
+  q.unsubscribe(reader);
+
+  for (size_t i = 0; i < 64; ++i)
+  {
+    REQUIRE(q.try_emplace(i));
+    REQUIRE(q.try_claim(worker3));
+    q.release(worker3);
+    REQUIRE_EQ(q.try_claim(worker1), nullptr);
+  }
+}
+
+/***/
+TEST_CASE("single_produce_consumer_group")
+{
+  const size_t iter = 100'000;
+  constexpr size_t MAX_CONSUMERS = 4;
+  constexpr size_t WORKERS = 3;
+  SPBroadcastQueue<size_t, MAX_CONSUMERS> q{1024};
+
+  size_t const rid = q.subscribe();
+
+  std::array<size_t, WORKERS> worker_ids;
+  for (auto& worker_id : worker_ids)
+  {
+    worker_id = q.subscribe_group(0);
+  }
+
+  std::thread producer{[&q, iter]()
+                       {
+                         for (size_t i = 0; i < iter; ++i)
+                         {
+                           while (!q.try_emplace(i))
+                           {
+                             std::this_thread::yield();
+                           }
+                         }
+                       }};
+
+  std::atomic<size_t> claimed{0};
+  std::atomic<size_t> group_sum{0};
+
+  std::vector<std::thread> workers;
+  for (size_t tid = 0; tid < WORKERS; ++tid)
+  {
+    workers.emplace_back(
+      [&q, &claimed, &group_sum, &worker_ids, tid, iter]()
+      {
+        size_t sum = 0;
+        size_t last = 0;
+        bool first = true;
+
+        while (claimed.load() < iter)
+        {
+          auto const* v = q.try_claim(worker_ids[tid]);
+
+          if (!v)
+          {
+            std::this_thread::yield();
+            continue;
+          }
+
+          // each member sees the elements in order
+          REQUIRE((first || (*v > last)));
+          first = false;
+          last = *v;
+
+          sum += *v;
+          q.release(worker_ids[tid]);
+          claimed += 1;
+        }
+
+        group_sum += sum;
+      });
+  }
+
+  size_t sum = 0;
+  for (size_t i = 0; i < iter; ++i)
+  {
+    while (!q.front(rid))
+    {
+      std::this_thread::yield();
+    }
+
+    sum += *q.front(rid);
+    q.pop(rid);
+  }
+
+  producer.join();
+
+  for (auto& w : workers)
+  {
+    w.join();
+  }
+
+  // the reader sees the whole stream and the group sees each element exactly once
+  REQUIRE_EQ(sum, iter * (iter - 1) / 2);
+  REQUIRE_EQ(claimed.load(), iter);
+  REQUIRE_EQ(group_sum.load(), iter * (iter - 1) / 2);
+}
+
+/***/
+TEST_CASE("overwrite_policy")
+{
+  constexpr size_t MAX_CONSUMERS = 2;
+  SPBroadcastQueue<size_t, MAX_CONSUMERS, std::allocator<size_t>, BusySpinWaitStrategy, OverflowPolicy::Overwrite> q{16};
+
+  size_t const fast_reader = q.subscribe();
+  size_t const slow_reader = q.subscribe();
+
+  for (size_t i = 0; i < 40; ++i)
+  {
+    // the producer never waits for the slow reader
+    REQUIRE(q.try_emplace(i));
+
+    REQUIRE(q.front(fast_reader));
+    size_t const value = *q.front(fast_reader);
+    REQUIRE(q.validate(fast_reader));
+    REQUIRE_EQ(value, i);
+    q.pop(fast_reader);
+  }
+
+  REQUIRE_EQ(q.front(fast_reader), nullptr);
+  REQUIRE_EQ(q.lost_count(fast_reader), 0);
+
+  // the slow reader was lapped, it resumes from the oldest element still in the queue
+  for (size_t i = 24; i < 40; ++i)
+  {
+    REQUIRE(q.front(slow_reader));
+    size_t const value = *q.front(slow_reader);
+    REQUIRE(q.validate(slow_reader));
+    REQUIRE_EQ(value, i);
+    q.pop(slow_reader);
+  }
+
+  REQUIRE_EQ(q.front(slow_reader), nullptr);
+  REQUIRE_EQ(q.lost_count(slow_reader), 24);
+
+  // an element overwritten after front() fails validation and is skipped
+  REQUIRE(q.try_emplace(size_t{40}));
+  REQUIRE(q.front(slow_reader));
+
+  for (size_t i = 41; i < 57; ++i)
+  {
+    REQUIRE(q.try_emplace(i));
+  }
+
+  REQUIRE_FALSE(q.validate(slow_reader));
+  REQUIRE(q.front(slow_reader));
+  REQUIRE_EQ(*q.front(slow_reader), 41);
+  REQUIRE_EQ(q.lost_count(slow_reader), 25);
+
+  // resubscribing resets the lost count
+  q.unsubscribe(slow_reader);
+  size_t const rid = q.subscribe();
+  REQUIRE_EQ(q.lost_count(rid), 0);
+}
+
+struct OverwriteTestType
+{
+  size_t value;
+  size_t check;
+};
+
+/***/
+TEST_CASE("single_produce_overwrite_consumer")
+{
+  const size_t iter = 200'000;
+  SPBroadcastQueue<OverwriteTestType, 1, std::allocator<OverwriteTestType>, BusySpinWaitStrategy, OverflowPolicy::Overwrite> q{64};
+
+  size_t const rid = q.subscribe();
+
+  std::thread producer{[&q, iter]()
+                       {
+                         for (size_t i = 0; i < iter; ++i)
+                         {
+                           q.emplace(OverwriteTestType{i, ~i});
+
+                           if ((i % 64) == 0)
+                           {
+                             // let the consumer run and get lapped occasionally
+                             std::this_thread::yield();
+                           }
+                         }
+                       }};
+
+  size_t delivered = 0;
+  size_t next = 0;
+
+  while (next < iter)
+  {
+    auto const* item = q.front(rid);
+
+    if (!item)
+    {
+      std::this_thread::yield();
+      continue;
+    }
+
+    OverwriteTestType const copy = *item;
+
+    if (!q.validate(rid))
+    {
+      continue;
+    }
+
+    // a validated copy is never torn and the elements are seen in order
+    REQUIRE_EQ(copy.check, ~copy.value);
+    REQUIRE_GE(copy.value, next);
+    next = copy.value + 1;
+    delivered += 1;
+    q.pop(rid);
+  }
+
+  producer.join();
+
+  // every element was either delivered or counted as lost
+  REQUIRE_EQ(q.front(rid), nullptr);
+  REQUIRE_EQ(delivered + q.lost_count(rid), iter);
+}
+
+/***/
+template <size_t MAX_READERS>
+using EvictingSPBroadcastQueue =
+  SPBroadcastQueue<size_t, MAX_READERS, std::allocator<size_t>, BusySpinWaitStrategy, OverflowPolicy::Block,
+                   PublishPolicy::WriteIndex, ReadIndexLayout::Packed, Telemetry::Disabled, Eviction::Enabled>;
+
+/***/
+TEST_CASE("evict_lagging_reader")
+{
+  constexpr size_t MAX_CONSUMERS = 2;
+  EvictingSPBroadcastQueue<MAX_CONSUMERS> q{16, 4};
+
+  REQUIRE_THROWS(q.set_max_reader_lag(16));
+  q.set_max_reader_lag(8);
+
+  size_t const fast_reader = q.subscribe();
+  size_t slow_reader = q.subscribe();
+
+  // an empty queue and an evicted reader both return nullptr, evicted() tells them apart
+  REQUIRE_EQ(q.front(slow_reader), nullptr);
+  REQUIRE_FALSE(q.evicted(slow_reader));
+
+  for (size_t i = 0; i < 64; ++i)
+  {
+    // the producer evicts the slow reader instead of waiting for it
+    REQUIRE(q.try_emplace(i));
+
+    REQUIRE(q.front(fast_reader));
+    REQUIRE_EQ(*q.front(fast_reader), i);
+    q.pop(fast_reader);
+  }
+
+  REQUIRE_FALSE(q.evicted(fast_reader));
+  REQUIRE(q.evicted(slow_reader));
+  REQUIRE_EQ(q.front(slow_reader), nullptr);
+  REQUIRE(q.read_available(slow_reader).empty());
+  REQUIRE_EQ(q.front_wait(slow_reader), nullptr);
+
+  // pop does not bring an evicted reader back
+  q.pop(slow_reader);
+  REQUIRE(q.evicted(slow_reader));
+
+  // an evicted reader has to unsubscribe before the slot can be reused
+  REQUIRE_THROWS((void)q.subscribe());
+  q.unsubscribe(slow_reader);
+  slow_reader = q.subscribe();
+  REQUIRE_FALSE(q.evicted(slow_reader));
+
+  // readers within the max lag are not evicted
+  REQUIRE(q.front(slow_reader));
+  q.pop(slow_reader);
+
+  for (size_t i = 0; i < 64; ++i)
+  {
+    REQUIRE(q.try_emplace(i));
+
+    if ((i % 4) == 3)
+    {
+      for (size_t j = 0; j < 4; ++j)
+      {
+        q.pop(fast_reader);
+        q.pop(slow_reader);
+      }
+    }
+  }
+
+  REQUIRE_FALSE(q.evicted(fast_reader));
+  REQUIRE_FALSE(q.evicted(slow_reader));
+}
+
+/***/
+TEST_CASE("single_produce_evict_stuck_consumer")
+{
+  const size_t iter = 100'000;
+  constexpr size_t MAX_CONSUMERS = 3;
+  EvictingSPBroadcastQueue<MAX_CONSUMERS> q{1024};
+  q.set_max_reader_lag(512);
+
+  // a reader that never consumes does not stall the producer
+  size_t const stuck_reader = q.subscribe();
+
+  std::array<size_t, 2> reader_ids{q.subscribe(), q.subscribe()};
+
+  std::thread producer{[&q, iter]()
+                       {
+                         for (size_t i = 0; i < iter; ++i)
+                         {
+                           while (!q.try_emplace(i))
+                           {
+                             std::this_thread::yield();
+                           }
+                         }
+                       }};
+
+  std::vector<std::thread> consumers;
+  for (size_t tid = 0; tid < reader_ids.size(); ++tid)
+  {
+    consumers.emplace_back(
+      [&q, &reader_ids, tid, iter]()
+      {
+        size_t rid = reader_ids[tid];
+        size_t next = 0;
+
+        // a reader gets the elements in order, an evicted reader subscribes again and continues
+        // from the latest element
+        while (next < iter)
+        {
+          size_t const* item = q.front(rid);
+
+          if (item)
+          {
+            size_t const value = *item;
+
+            if (!q.evicted(rid))
+            {
+              REQUIRE((next == 0 || value == next));
+              next = value + 1;
+              q.pop(rid);
+              continue;
+            }
+          }
+
+          if (q.evicted(rid))
+          {
+            q.unsubscribe(rid);
+            rid = q.subscribe();
+            next = 0;
+          }
+          else
+          {
+            std::this_thread::yield();
+          }
+        }
+
+        q.unsubscribe(rid);
+      });
+  }
+
+  producer.join();
+
+  for (auto& c : consumers)
+  {
+    c.join();
+  }
+
+  REQUIRE(q.evicted(stuck_reader));
+}
+
+/***/
+TEST_CASE("eviction_disabled")
+{
+  // without Eviction::Enabled the producer waits for a stuck reader and nullptr always means empty
+  SPBroadcastQueue<size_t, 2> q{16};
+
+  size_t const stuck_reader = q.subscribe();
+  size_t const reader = q.subscribe();
+
+  REQUIRE_EQ(q.front(reader), nullptr);
+  REQUIRE_FALSE(q.evicted(reader));
+
+  for (size_t i = 0; i < 16; ++i)
+  {
+    REQUIRE(q.try_emplace(i));
+    REQUIRE_EQ(*q.front(reader), i);
+    q.pop(reader);
+  }
+
+  REQUIRE_FALSE(q.try_emplace(size_t{16}));
+  REQUIRE_EQ(q.front(reader), nullptr);
+  REQUIRE_FALSE(q.evicted(reader));
+  REQUIRE_FALSE(q.evicted(stuck_reader));
+  REQUIRE_EQ(*q.front(stuck_reader), 0);
+}
+
+/***/
+TEST_CASE("slot_sequence_publish_policy")
+{
+  constexpr size_t MAX_CONSUMERS = 2;
+  SPBroadcastQueue<size_t, MAX_CONSUMERS, std::allocator<size_t>, BusySpinWaitStrategy, OverflowPolicy::Block, PublishPolicy::SlotSequence> q{16};
+
+  size_t const rid_1 = q.subscribe();
+  size_t const rid_2 = q.subscribe();
+
+  REQUIRE_EQ(q.front(rid_1), nullptr);
+
+  std::array<size_t, 3> const values{0, 1, 2};
+  REQUIRE(q.try_emplace_n(values.begin(), values.end()));
+
+  for (size_t i = 3; i < 16; ++i)
+  {
+    REQUIRE(q.try_emplace(i));
+  }
+
+  REQUIRE_FALSE(q.try_emplace(size_t{16}));
+
+  for (size_t i = 0; i < 16; ++i)
+  {
+    REQUIRE(q.front(rid_1));
+    REQUIRE_EQ(*q.front(rid_1), i);
+    q.pop(rid_1);
+  }
+
+  REQUIRE_EQ(q.front(rid_1), nullptr);
+
+  // the producer still waits for the slowest reader
+  REQUIRE_FALSE(q.try_emplace(size_t{16}));
+
+  for (size_t i = 0; i < 16; ++i)
+  {
+    REQUIRE(q.front(rid_2));
+    REQUIRE_EQ(*q.front(rid_2), i);
+    q.pop(rid_2);
+  }
+
+  for (size_t i = 16; i < 48; ++i)
+  {
+    REQUIRE(q.try_emplace(i));
+
+    REQUIRE(q.front(rid_1));
+    REQUIRE_EQ(*q.front(rid_1), i);
+    q.pop(rid_1);
+
+    REQUIRE(q.front(rid_2));
+    REQUIRE_EQ(*q.front(rid_2), i);
+    q.pop(rid_2);
+  }
+
+  REQUIRE_EQ(q.front(rid_1), nullptr);
+  REQUIRE_EQ(q.front(rid_2), nullptr);
+}
+
+/***/
+TEST_CASE("slot_sequence_scan_published")
+{
+  // front() caches the furthest published element, a backlog longer than a scan and elements
+  // published after the scan are all delivered in order
+  SPBroadcastQueue<size_t, 1, std::allocator<size_t>, BusySpinWaitStrategy, OverflowPolicy::Block, PublishPolicy::SlotSequence> q{64};
+
+  size_t const rid = q.subscribe();
+  size_t next_write = 0;
+  size_t next_read = 0;
+
+  for (size_t round = 0; round < 16; ++round)
+  {
+    for (size_t i = 0; i < 40; ++i)
+    {
+      REQUIRE(q.try_emplace(next_write++));
+    }
+
+    for (size_t i = 0; i < 20; ++i)
+    {
+      REQUIRE(q.front(rid));
+      REQUIRE_EQ(*q.front(rid), next_read++);
+      q.pop(rid);
+    }
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+      REQUIRE(q.try_emplace(next_write++));
+    }
+
+    while (next_read != next_write)
+    {
+      REQUIRE(q.front(rid));
+      REQUIRE_EQ(*q.front(rid), next_read++);
+      q.pop(rid);
+    }
+
+    REQUIRE_EQ(q.front(rid), nullptr);
+  }
+}
+
+/***/
+TEST_CASE("single_produce_multiple_consumers_slot_sequence")
+{
+  const size_t iter = 1'000'000;
+  constexpr size_t MAX_CONSUMERS = 4;
+  SPBroadcastQueue<size_t, MAX_CONSUMERS, std::allocator<size_t>, BusySpinWaitStrategy, OverflowPolicy::Block, PublishPolicy::SlotSequence> q{1024};
+
+  std::array<std::atomic<bool>, MAX_CONSUMERS> flags = {false};
+
+  std::thread producer{[&q, &flags, iter]()
+                       {
+                         for (auto const& flag : flags)
+                         {
+                           while (!flag)
+                             ;
+                         }
+
+                         for (size_t i = 0; i < iter; ++i)
+                         {
+                           q.emplace(i);
+                         }
+                       }};
+
+  std::vector<std::thread> consumers;
+  for (size_t tid = 0; tid < MAX_CONSUMERS; ++tid)
+  {
+    consumers.emplace_back(
+      [&q, &flags, tid, iter]()
+      {
+        size_t rid = q.subscribe();
+        flags[tid] = true;
+
+        for (size_t i = 0; i < iter; ++i)
+        {
+          while (!q.front(rid))
+            ;
+          REQUIRE_EQ(*q.front(rid), i);
+          q.pop(rid);
+        }
+
+        REQUIRE_EQ(q.front(rid), nullptr);
+        q.unsubscribe(rid);
+      });
+  }
+
+  for (auto& c : consumers)
+  {
+    c.join();
+  }
+  producer.join();
+}
+
+/***/
+TEST_CASE("many_readers_min_read_idx")
+{
+  // an odd number of readers so that the min is also found in the tail of the reduction
+  constexpr size_t MAX_CONSUMERS = 37;
+  SPBroadcastQueue<size_t, MAX_CONSUMERS> q{16, 16};
+
+  std::array<size_t, MAX_CONSUMERS> reader_ids;
+  for (auto& rid : reader_ids)
+  {
+    rid = q.subscribe();
+  }
+
+  size_t write_idx = 0;
+
+  for (size_t slowest = 0; slowest < MAX_CONSUMERS; ++slowest)
+  {
+    // every reader but the slowest consumes all the elements
+    while (q.try_emplace(write_idx))
+    {
+      ++write_idx;
+    }
+
+    for (size_t i = 0; i < MAX_CONSUMERS; ++i)
+    {
+      if (i == slowest)
+      {
+        continue;
+      }
+
+      while (q.front(reader_ids[i]))
+      {
+        q.pop(reader_ids[i]);
+      }
+    }
+
+    // the producer waits for the slowest reader
+    REQUIRE_FALSE(q.try_emplace(write_idx));
+
+    while (q.front(reader_ids[slowest]))
+    {
+      q.pop(reader_ids[slowest]);
+    }
+
+    REQUIRE(q.try_emplace(write_idx));
+    ++write_idx;
+  }
+}
+
+/***/
+TEST_CASE("single_produce_multiple_consumers_padded_read_index")
+{
+  const size_t iter = 1'000'000;
+  constexpr size_t MAX_CONSUMERS = 4;
+  SPBroadcastQueue<size_t, MAX_CONSUMERS, std::allocator<size_t>, BusySpinWaitStrategy, OverflowPolicy::Block,
+                   PublishPolicy::WriteIndex, ReadIndexLayout::Padded>
+    q{1024, 1024};
+
+  std::array<size_t, MAX_CONSUMERS> reader_ids;
+  for (auto& rid : reader_ids)
+  {
+    rid = q.subscribe();
+  }
+
+  std::thread producer{[&q, iter]()
+                       {
+                         for (size_t i = 0; i < iter; ++i)
+                         {
+                           q.emplace(i);
+                         }
+                       }};
+
+  std::vector<std::thread> consumers;
+  for (size_t tid = 0; tid < MAX_CONSUMERS; ++tid)
+  {
+    consumers.emplace_back(
+      [&q, &reader_ids, tid, iter]()
+      {
+        size_t const rid = reader_ids[tid];
+        size_t sum = 0;
+
+        for (size_t i = 0; i < iter; ++i)
+        {
+          while (!q.front(rid))
+            ;
+          sum += *q.front(rid);
+          q.pop(rid);
+        }
+
+        REQUIRE_EQ(q.front(rid), nullptr);
+        REQUIRE_EQ(sum, iter * (iter - 1) / 2);
+        q.unsubscribe(rid);
+      });
+  }
+
+  for (auto& c : consumers)
+  {
+    c.join();
+  }
+  producer.join();
+}
+
+/***/
+TEST_CASE("dynamic_readers")
+{
+  SPBroadcastQueue<size_t, DYNAMIC_READERS> q{16, 100, 16};
+  REQUIRE_EQ(q.max_readers(), 100);
+
+  REQUIRE_THROWS(SPBroadcastQueue<size_t, DYNAMIC_READERS>{16, 0, 16});
+
+  std::vector<size_t> reader_ids;
+  for (size_t i = 0; i < q.max_readers(); ++i)
+  {
+    reader_ids.push_back(q.subscribe());
+    REQUIRE_EQ(reader_ids.back(), i);
+  }
+
+  REQUIRE_THROWS((void)q.subscribe());
+  REQUIRE_THROWS((void)q.subscribe_group(100));
+
+  for (size_t i = 0; i < 16; ++i)
+  {
+    REQUIRE(q.try_emplace(i));
+  }
+
+  // the producer waits for the slowest reader
+  for (size_t rid : reader_ids)
+  {
+    if (rid != 77)
+    {
+      while (q.front(rid))
+      {
+        q.pop(rid);
+      }
+    }
+  }
+
+  REQUIRE_FALSE(q.try_emplace(size_t{16}));
+
+  for (size_t i = 0; i < 16; ++i)
+  {
+    REQUIRE(q.front(77));
+    REQUIRE_EQ(*q.front(77), i);
+    q.pop(77);
+  }
+
+  REQUIRE(q.try_emplace(size_t{16}));
+
+  // the slot of a reader is reused after it unsubscribes, the other readers keep going
+  q.unsubscribe(77);
+  REQUIRE_EQ(q.subscribe(), 77);
+
+  for (size_t rid : reader_ids)
+  {
+    REQUIRE(q.front(rid));
+    REQUIRE_EQ(*q.front(rid), 16);
+    q.pop(rid);
+  }
+}
+
+/***/
+TEST_CASE("single_produce_multiple_consumers_dynamic_readers")
+{
+  const size_t iter = 1'000'000;
+  size_t const max_consumers = 70;
+  size_t const consumers_count = 3;
+  SPBroadcastQueue<size_t, DYNAMIC_READERS> q{1024, max_consumers, 4};
+
+  // only some of the readers are subscribed, in different words of the bitmap
+  std::vector<size_t> reader_ids;
+  for (size_t i = 0; i < max_consumers; ++i)
+  {
+    reader_ids.push_back(q.subscribe());
+  }
+
+  for (size_t i = 0; i < max_consumers; ++i)
+  {
+    if ((i != 3) && (i != 64) && (i != 69))
+    {
+      q.unsubscribe(reader_ids[i]);
+    }
+  }
+
+  reader_ids = {3, 64, 69};
+
+  std::thread producer{[&q, iter]()
+                       {
+                         for (size_t i = 0; i < iter; ++i)
+                         {
+                           q.emplace(i);
+                         }
+                       }};
+
+  std::vector<std::thread> consumers;
+  for (size_t tid = 0; tid < consumers_count; ++tid)
+  {
+    consumers.emplace_back(
+      [&q, &reader_ids, tid, iter]()
+      {
+        size_t const rid = reader_ids[tid];
+        size_t sum = 0;
+
+        for (size_t i = 0; i < iter; ++i)
+        {
+          while (!q.front(rid))
+            ;
+          sum += *q.front(rid);
+          q.pop(rid);
+        }
+
+        REQUIRE_EQ(q.front(rid), nullptr);
+        REQUIRE_EQ(sum, iter * (iter - 1) / 2);
+        q.unsubscribe(rid);
+      });
+  }
+
+  for (auto& c : consumers)
+  {
+    c.join();
+  }
+  producer.join();
+}
+
+/***/
+TEST_CASE("concurrent_subscribe")
+{
+  constexpr size_t MAX_CONSUMERS = 8;
+  SPBroadcastQueue<size_t, MAX_CONSUMERS> q{16};
+
+  std::array<size_t, MAX_CONSUMERS> reader_ids;
+  std::vector<std::thread> subscribers;
+
+  for (size_t tid = 0; tid < MAX_CONSUMERS; ++tid)
+  {
+    subscribers.emplace_back([&q, &reader_ids, tid]() { reader_ids[tid] = q.subscribe(); });
+  }
+
+  for (auto& t : subscribers)
+  {
+    t.join();
+  }
+
+  // every subscriber got its own slot
+  REQUIRE_EQ(std::set<size_t>(reader_ids.begin(), reader_ids.end()).size(), MAX_CONSUMERS);
+  REQUIRE_THROWS((void)q.subscribe());
+}
+
+/***/
+TEST_CASE("single_produce_hot_join_consumers")
+{
+  const size_t iter = 100'000;
+  constexpr size_t MAX_CONSUMERS = 4;
+  SPBroadcastQueue<size_t, MAX_CONSUMERS> q{64};
+
+  // a reader that stays subscribed, so that the producer always has one
+  size_t const rid = q.subscribe();
+  std::atomic<bool> done{false};
+
+  std::thread producer{[&q, iter]()
+                       {
+                         for (size_t i = 0; i < iter; ++i)
+                         {
+                           while (!q.try_emplace(i))
+                           {
+                             std::this_thread::yield();
+                           }
+                         }
+                       }};
+
+  // readers keep joining and leaving, the elements they see must be consecutive, an element the
+  // producer overwrote while a reader joined would show up as a gap
+  std::vector<std::thread> consumers;
+  for (size_t tid = 0; tid < MAX_CONSUMERS - 1; ++tid)
+  {
+    consumers.emplace_back(
+      [&q, &done]()
+      {
+        while (!done.load())
+        {
+          size_t const hot_rid = q.subscribe();
+          size_t const* item = q.front(hot_rid);
+
+          for (size_t n = 0; (n < 256) && !done.load(); ++n)
+          {
+            while (!item && !done.load())
+            {
+              std::this_thread::yield();
+              item = q.front(hot_rid);
+            }
+
+            if (!item)
+            {
+              break;
+            }
+
+            size_t const value = *item;
+            q.pop(hot_rid);
+
+            item = q.front(hot_rid);
+            while (!item && !done.load())
+            {
+              std::this_thread::yield();
+              item = q.front(hot_rid);
+            }
+
+            if (item)
+            {
+              REQUIRE_EQ(*item, value + 1);
+            }
+          }
+
+          q.unsubscribe(hot_rid);
+        }
+      });
+  }
+
+  for (size_t i = 0; i < iter; ++i)
+  {
+    while (!q.front(rid))
+    {
+      std::this_thread::yield();
+    }
+
+    REQUIRE_EQ(*q.front(rid), i);
+    q.pop(rid);
+  }
+
+  done.store(true);
+  producer.join();
+
+  for (auto& c : consumers)
+  {
+    c.join();
+  }
+}
+
+/***/
+TEST_CASE("subscribe_from")
+{
+  constexpr size_t MAX_CONSUMERS = 6;
+  SPBroadcastQueue<size_t, MAX_CONSUMERS> q{16, 4};
+
+  // without any element all the readers start from the first one
+  size_t const rid = q.subscribe(SubscribeFrom::Oldest);
+  REQUIRE_EQ(q.sequence(rid), 0);
+
+  for (size_t i = 0; i < 16; ++i)
+  {
+    REQUIRE(q.try_emplace(i));
+  }
+
+  for (size_t i = 0; i < 8; ++i)
+  {
+    q.pop(rid);
+  }
+
+  for (size_t i = 16; i < 24; ++i)
+  {
+    REQUIRE(q.try_emplace(i));
+  }
+
+  // the oldest element still in the queue
+  size_t const oldest_rid = q.subscribe(SubscribeFrom::Oldest);
+  REQUIRE_EQ(q.sequence(oldest_rid), 8);
+
+  for (size_t i = 8; i < 24; ++i)
+  {
+    REQUIRE(q.front(oldest_rid));
+    REQUIRE_EQ(*q.front(oldest_rid), i);
+    q.pop(oldest_rid);
+  }
+
+  REQUIRE_EQ(q.front(oldest_rid), nullptr);
+
+  size_t const latest_rid = q.subscribe(SubscribeFrom::Latest);
+  REQUIRE(q.front(latest_rid));
+  REQUIRE_EQ(*q.front(latest_rid), 23);
+  REQUIRE_EQ(q.sequence(latest_rid), 23);
+
+  size_t const at_rid = q.subscribe_at(20);
+  REQUIRE(q.front(at_rid));
+  REQUIRE_EQ(*q.front(at_rid), 20);
+
+  // a sequence that is no longer in the queue starts from the oldest element
+  size_t const old_rid = q.subscribe_at(3);
+  REQUIRE_EQ(q.sequence(old_rid), 8);
+  REQUIRE(q.front(old_rid));
+  REQUIRE_EQ(*q.front(old_rid), 8);
+  q.unsubscribe(old_rid);
+
+  for (size_t i = 8; i < 24; ++i)
+  {
+    q.pop(rid);
+  }
+
+  // the next element to be written
+  size_t const next_rid = q.subscribe_at(24);
+  REQUIRE_EQ(q.front(next_rid), nullptr);
+  REQUIRE(q.try_emplace(size_t{24}));
+  REQUIRE(q.front(next_rid));
+  REQUIRE_EQ(*q.front(next_rid), 24);
+  q.unsubscribe(next_rid);
+
+  // a sequence that was not written yet is rejected and does not take a slot
+  REQUIRE_THROWS((void)q.subscribe_at(26));
+  REQUIRE_NOTHROW(q.unsubscribe(q.subscribe()));
+}
+
+/***/
+TEST_CASE("telemetry")
+{
+  constexpr size_t MAX_CONSUMERS = 2;
+  SPBroadcastQueue<size_t, MAX_CONSUMERS, std::allocator<size_t>, BusySpinWaitStrategy, OverflowPolicy::Block,
+                   PublishPolicy::WriteIndex, ReadIndexLayout::Packed, Telemetry::Enabled>
+    q{16, 4};
+
+  size_t const rid_1 = q.subscribe();
+  size_t const rid_2 = q.subscribe();
+
+  REQUIRE_EQ(q.front(rid_1), nullptr);
+  REQUIRE_EQ(q.front(rid_1), nullptr);
+  REQUIRE_EQ(q.reader_stats(rid_1).empty_polls, 2);
+  REQUIRE_EQ(q.reader_stats(rid_2).empty_polls, 0);
+
+  for (size_t i = 0; i < 16; ++i)
+  {
+    REQUIRE(q.try_emplace(i));
+  }
+
+  REQUIRE_FALSE(q.try_emplace(size_t{16}));
+
+  std::array<size_t, 2> const values{16, 17};
+  REQUIRE_FALSE(q.try_emplace_n(values.begin(), values.end()));
+
+  auto stats = q.producer_stats();
+  REQUIRE_EQ(stats.written, 16);
+  REQUIRE_EQ(stats.full, 2);
+  REQUIRE_EQ(stats.depth, 16);
+  REQUIRE_EQ(stats.max_depth, 16);
+  REQUIRE_GT(stats.min_read_idx_reloads, 0);
+
+  // the readers commit their reads in batches of 4
+  for (size_t i = 0; i < 16; ++i)
+  {
+    q.pop(rid_1);
+  }
+
+  for (size_t i = 0; i < 6; ++i)
+  {
+    q.pop(rid_2);
+  }
+
+  REQUIRE_EQ(q.reader_stats(rid_1).lag, 0);
+  REQUIRE_EQ(q.reader_stats(rid_2).lag, 12);
+  REQUIRE_EQ(q.producer_stats().depth, 12);
+
+  REQUIRE(q.try_emplace_n(values.begin(), values.end()));
+
+  stats = q.producer_stats();
+  REQUIRE_EQ(stats.written, 18);
+  REQUIRE_EQ(stats.full, 2);
+  REQUIRE_EQ(q.reader_stats(rid_2).lag, 14);
+
+  // resubscribing resets the counters of the reader
+  q.unsubscribe(rid_1);
+  size_t const rid_3 = q.subscribe();
+  REQUIRE_EQ(q.reader_stats(rid_3).empty_polls, 0);
+}
+
+/***/
+TEST_CASE("telemetry_disabled_storage")
+{
+  // without Telemetry::Enabled the counters of the producer do not take a cache line
+  using disabled_queue_t = SPBroadcastQueue<size_t, 2>;
+  using enabled_queue_t = SPBroadcastQueue<size_t, 2, std::allocator<size_t>, BusySpinWaitStrategy, OverflowPolicy::Block,
+                                           PublishPolicy::WriteIndex, ReadIndexLayout::Packed, Telemetry::Enabled>;
+
+  REQUIRE_GE(sizeof(enabled_queue_t), sizeof(disabled_queue_t) + 128);
+}
+
 TEST_SUITE_END();
\ No newline at end of file
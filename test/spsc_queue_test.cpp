@@ -0,0 +1,144 @@
+#include "doctest/doctest.h"
+
+#include "lockfree_queues/spsc_queue.h"
+
+#include <atomic>
+#include <set>
+#include <thread>
+
+TEST_SUITE_BEGIN("SPSCQueue");
+
+using namespace lockfree_queues;
+
+// TestType tracks correct usage of constructors and destructors
+struct SPSCTestType
+{
+  static std::set<SPSCTestType const*> constructed;
+
+  SPSCTestType(size_t v) noexcept
+  {
+    x = v;
+    REQUIRE_EQ(constructed.count(this), 0);
+    constructed.insert(this);
+  };
+
+  SPSCTestType() noexcept
+  {
+    REQUIRE_EQ(constructed.count(this), 0);
+    constructed.insert(this);
+  };
+
+  SPSCTestType(const SPSCTestType& other) noexcept
+  {
+    REQUIRE_EQ(constructed.count(this), 0);
+    REQUIRE_EQ(constructed.count(&other), 1);
+    constructed.insert(this);
+  };
+
+  ~SPSCTestType() noexcept
+  {
+    REQUIRE_EQ(constructed.count(this), 1);
+    constructed.erase(this);
+  };
+
+  size_t x;
+};
+
+std::set<const SPSCTestType*> SPSCTestType::constructed;
+
+/***/
+TEST_CASE("spsc_basic_produce_full_queue")
+{
+  {
+    SPSCQueue<SPSCTestType> q{16};
+
+    REQUIRE_EQ(q.front(), nullptr);
+    REQUIRE_EQ(q.capacity(), 16);
+
+    for (size_t iter = 0; iter < 3; ++iter)
+    {
+      for (size_t i = 0; i < 16; i++)
+      {
+        REQUIRE_EQ(q.try_emplace(i), true);
+      }
+
+      REQUIRE_EQ(SPSCTestType::constructed.size(), 16);
+      REQUIRE_EQ(q.try_emplace(), false);
+
+      for (size_t i = 0; i < 16; i++)
+      {
+        REQUIRE_EQ(q.front()->x, i);
+        q.pop();
+      }
+
+      REQUIRE_EQ(q.front(), nullptr);
+    }
+  }
+  REQUIRE_EQ(SPSCTestType::constructed.size(), 0);
+}
+
+/***/
+TEST_CASE("spsc_basic_produce_partial_queue")
+{
+  {
+    SPSCQueue<SPSCTestType> q{16};
+
+    for (size_t i = 0; i < 10; i++)
+    {
+      q.emplace();
+    }
+
+    REQUIRE(q.front());
+    REQUIRE_EQ(SPSCTestType::constructed.size(), 10);
+  }
+  REQUIRE_EQ(SPSCTestType::constructed.size(), 0);
+}
+
+/***/
+TEST_CASE("spsc_reserve_commit")
+{
+  {
+    SPSCQueue<SPSCTestType> q{16};
+
+    for (size_t i = 0; i < 40; i++)
+    {
+      SPSCTestType* slot = q.try_reserve();
+      REQUIRE(slot);
+      ::new (static_cast<void*>(slot)) SPSCTestType{i};
+      q.commit();
+
+      REQUIRE_EQ(q.front()->x, i);
+      q.pop();
+    }
+  }
+  REQUIRE_EQ(SPSCTestType::constructed.size(), 0);
+}
+
+/***/
+TEST_CASE("spsc_single_produce_single_consumer")
+{
+  const size_t iter = 1'000'000;
+  SPSCQueue<size_t> q{1024};
+
+  std::thread producer{[&q, iter]
+                       {
+                         for (size_t i = 0; i < iter; ++i)
+                         {
+                           q.emplace(i);
+                         }
+                       }};
+
+  for (size_t i = 0; i < iter; ++i)
+  {
+    while (!q.front())
+      ;
+    REQUIRE_EQ(*q.front(), i);
+    q.pop();
+  }
+
+  REQUIRE_EQ(q.front(), nullptr);
+
+  producer.join();
+}
+
+TEST_SUITE_END();